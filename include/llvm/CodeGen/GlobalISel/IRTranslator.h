@@ -20,15 +20,20 @@
 #define LLVM_CODEGEN_GLOBALISEL_IRTRANSLATOR_H
 
 #include "Types.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/IR/Constants.h"
 
 namespace llvm {
 // Forward declarations.
+class BasicBlock;
+class CallLowering;
 class Constant;
 class Instruction;
+class MachineBasicBlock;
+class MachineFunction;
 class MachineInstr;
-class MachineIRBuilder;
+class MachineRegisterInfo;
 
 // Technically the pass should run on an hypothetical MachineModule,
 // since it should translate Global into some sort of MachineGlobal.
@@ -43,8 +48,8 @@ public:
   static char ID;
 
 private:
-  // Interface used to lower the everything related to calls.
-  //  TargetLowering *CallLowering;
+  /// Interface used to lower the everything related to calls.
+  const CallLowering *CLI;
   // Mapping of the values of the current LLVM IR function
   // to the related virtual registers.
   // We need several virtual registers for the lowering of things
@@ -64,6 +69,18 @@ private:
   // do not appear in that map.
   DenseMap<const Constant *, SmallVector<MachineInstr *, 1>> ConstantToSequence;
 
+  /// Mapping of the basic blocks of the current LLVM IR function to the
+  /// related machine basic blocks.
+  DenseMap<const BasicBlock *, MachineBasicBlock *> BBToMBB;
+
+  /// Get or create the virtual register holding \p Val.
+  /// The virtual register is generic: it only has a size, the size of the
+  /// type of \p Val.
+  unsigned getOrCreateVReg(const Value &Val);
+
+  /// Get or create the machine basic block for \p BB.
+  MachineBasicBlock &getOrCreateBB(const BasicBlock &BB);
+
   /* A bunch of methods targeting ADD, SUB, etc. */
   // Return true if the translation was successful, false
   // otherwise.
@@ -79,18 +96,29 @@ private:
   //   ValToReg. Otherwise, update ValToVReg and register the
   //   sequence to materialize the constant in ConstantToSequence.
   // 3. Create the generic instruction.
-  bool translateADD(const Instruction &Inst);
+  bool translateBinaryOp(unsigned Opcode, const Instruction &Inst);
+
+  /// Translate an unconditional branch into a G_BR.
+  bool translateBr(const Instruction &Inst);
 
-  // Builder for machine instruction a la IRBuilder.
-  // I.e., compared to regular MIBuilder, this one also inserts the instruction
-  // in the current block, it can creates block, etc., basically a kind of
-  // IRBuilder, but for Machine IR.
-  MachineIRBuilder *MIRBuilder;
+  /// Translate a return through the call lowering of the target.
+  bool translateReturn(const Instruction &Inst);
 
-  // Return true if the translation from LLVM IR to Machine IR
-  // suceeded.
-  // See translateXXX for details.
-  bool translate(const Instruction &);
+  /// Builder for machine instruction a la IRBuilder.
+  /// I.e., compared to regular MIBuilder, this one also inserts the
+  /// instruction in the current block, it can creates block, etc., basically
+  /// a kind of IRBuilder, but for Machine IR.
+  MachineIRBuilder MIRBuilder;
+
+  /// MachineRegisterInfo used to create virtual registers.
+  MachineRegisterInfo *MRI;
+
+  /// Translate \p Inst into its corresponding MachineInstr instruction(s).
+  /// Insert the newly translated instruction(s) right where the MIRBuilder
+  /// is set.
+  ///
+  /// \return true if the translation succeeded.
+  bool translate(const Instruction &Inst);
 
   // * Insert all the code needed to materialize the constants
   // at the proper place. E.g., Entry block or dominator block
@@ -101,6 +129,10 @@ public:
   // Ctor, nothing fancy.
   IRTranslator();
 
+  const char *getPassName() const override {
+    return "IRTranslator";
+  }
+
   // Instead of having the instance of the IRTranslatorToolkit
   // as an argument of the constructor of IRTranslator, we ask
   // the target the instance of the toolkit for each MachineFunction.
@@ -15,6 +15,7 @@
 #define LLVM_CODEGEN_MACHINEREGISTERINFO_H
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IndexedMap.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/CodeGen/MachineFunction.h"
@@ -62,6 +63,11 @@ private:
   IndexedMap<std::pair<const TargetRegisterClass*, MachineOperand*>,
              VirtReg2IndexFunctor> VRegInfo;
 
+  /// Map generic virtual registers to their size in bits. Generic virtual
+  /// registers are created by GlobalISel and have no register class until
+  /// instruction selection.
+  DenseMap<unsigned, unsigned> VRegToSize;
+
   /// RegAllocHints - This vector records register allocation hints for virtual
   /// registers. For each virtual register, it keeps a register and hint type
   /// pair making up the allocation hint. Hint type is target specific except
@@ -587,6 +593,14 @@ public:
   ///
   unsigned createVirtualRegister(const TargetRegisterClass *RegClass);
 
+  /// Create and return a new generic virtual register of \p Size bits. The
+  /// register has no register class.
+  unsigned createGenericVirtualRegister(unsigned Size);
+
+  /// Get the size in bits of \p VReg, or 0 if \p VReg is not a generic
+  /// virtual register.
+  unsigned getSize(unsigned VReg) const;
+
   /// getNumVirtRegs - Return the number of virtual registers created.
   ///
   unsigned getNumVirtRegs() const { return VRegInfo.size(); }
@@ -29,6 +29,10 @@ class raw_pwrite_stream;
 /// files if linked together are intended to be equivalent to the single output
 /// file that would have been code generated from M.
 ///
+/// With -split-codegen-partitions-per-output=K (K > 1), M is split into
+/// K * OSs.size() finer partitions which are distributed over the outputs by
+/// estimated cost, so that the threads get comparable amounts of work.
+///
 /// \returns M if OSs.size() == 1, otherwise returns std::unique_ptr<Module>().
 std::unique_ptr<Module>
 splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_pwrite_stream *> OSs,
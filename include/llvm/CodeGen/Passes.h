@@ -216,6 +216,11 @@ public:
     return true;
   }
 
+  /// This method should install an IR translator pass, which converts from
+  /// LLVM code to machine instructions with possibly generic opcodes.
+  /// It is used instead of addInstSelector() with -global-isel.
+  virtual bool addIRTranslator() { return true; }
+
   /// Add the complete, standard set of LLVM CodeGen passes.
   /// Fully developed targets will not generally override this.
   virtual void addMachinePasses();
@@ -10,6 +10,7 @@
 #ifndef LLVM_LIB_DEBUGINFO_DWARFUNIT_H
 #define LLVM_LIB_DEBUGINFO_DWARFUNIT_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugAbbrev.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugInfoEntry.h"
@@ -128,6 +129,21 @@ class DWARFUnit {
   // The compile unit debug information entry items.
   std::vector<DWARFDebugInfoEntryMinimal> DieArray;
 
+  /// An address range of a subprogram DIE. The DIE is identified by its
+  /// offset, which stays valid when the DIEs are cleared and parsed again.
+  struct SubprogramRange {
+    uint64_t LowPC;
+    uint64_t HighPC;
+    uint32_t DIEOffset;
+  };
+  /// Sorted, disjoint address ranges of the subprograms of this unit, built
+  /// by the first address lookup so that the next ones are binary searches.
+  std::vector<SubprogramRange> SubprogramIndex;
+  bool SubprogramIndexBuilt;
+  /// DIE subtrees of the subprograms found by address while DieArray only
+  /// holds the unit DIE, keyed by the offset of the subprogram.
+  DenseMap<uint32_t, std::vector<DWARFDebugInfoEntryMinimal>> SubprogramDIEs;
+
   class DWOHolder {
     object::OwningBinary<object::ObjectFile> DWOFile;
     std::unique_ptr<DWARFContext> DWOContext;
@@ -277,10 +293,15 @@ private:
   /// extractDIEsToVector - Appends all parsed DIEs to a vector.
   void extractDIEsToVector(bool AppendCUDie, bool AppendNonCUDIEs,
                            std::vector<DWARFDebugInfoEntryMinimal> &DIEs) const;
+  /// extractSubtreeToVector - Appends the DIE at \p DIEOffset and all its
+  /// descendants to a vector. Leaves the vector empty if the subtree is
+  /// malformed.
+  void extractSubtreeToVector(uint32_t DIEOffset,
+                              std::vector<DWARFDebugInfoEntryMinimal> &DIEs) const;
   /// setDIERelations - We read in all of the DIE entries into our flat list
   /// of DIE entries and now we need to go back through all of them and set the
   /// parent, sibling and child pointers for quick DIE navigation.
-  void setDIERelations();
+  static void setDIERelations(std::vector<DWARFDebugInfoEntryMinimal> &DIEs);
   /// clearDIEs - Clear parsed DIEs to keep memory usage low.
   void clearDIEs(bool KeepCUDie);
 
@@ -288,6 +309,19 @@ private:
   /// it was actually constructed.
   bool parseDWO();
 
+  /// forEachSubprogramDIE - Calls \p Fn on every subprogram DIE of the unit
+  /// in offset order. Unless the whole unit is already parsed, the DIEs are
+  /// decoded one at a time and not kept.
+  void forEachSubprogramDIE(
+      function_ref<void(const DWARFDebugInfoEntryMinimal &)> Fn);
+
+  /// buildSubprogramIndex - Fills SubprogramIndex.
+  void buildSubprogramIndex();
+
+  /// getSubprogramDIE - Returns the subprogram DIE at \p DIEOffset, with its
+  /// children. Only parses its subtree if the unit isn't parsed yet.
+  const DWARFDebugInfoEntryMinimal *getSubprogramDIE(uint32_t DIEOffset);
+
   /// getSubprogramForAddress - Returns subprogram DIE with address range
   /// encompassing the provided address. The pointer is alive as long as parsed
   /// compile unit DIEs are not cleared.
@@ -16,6 +16,8 @@
 #include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/Mutex.h"
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
@@ -26,6 +28,9 @@ namespace symbolize {
 using namespace object;
 using FunctionNameKind = DILineInfoSpecifier::FunctionNameKind;
 
+/// The symbolize* methods may be called concurrently from several threads.
+/// Queries on different modules run in parallel, while queries on the same
+/// module are serialized because the debug info is parsed lazily.
 class LLVMSymbolizer {
 public:
   struct Options {
@@ -35,12 +40,17 @@ public:
     bool RelativeAddresses : 1;
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
+    /// Maximum number of modules, and thus of debug info contexts, kept in the
+    /// cache. The least recently used module is released first. 0 means no
+    /// limit.
+    unsigned MaxOpenModules;
     Options(FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool UseSymbolTable = true, bool Demangle = true,
-            bool RelativeAddresses = false, std::string DefaultArch = "")
+            bool RelativeAddresses = false, std::string DefaultArch = "",
+            unsigned MaxOpenModules = 0)
         : PrintFunctions(PrintFunctions), UseSymbolTable(UseSymbolTable),
           Demangle(Demangle), RelativeAddresses(RelativeAddresses),
-          DefaultArch(DefaultArch) {}
+          DefaultArch(DefaultArch), MaxOpenModules(MaxOpenModules) {}
   };
 
   LLVMSymbolizer(const Options &Opts = Options()) : Opts(Opts) {}
@@ -54,6 +64,8 @@ public:
                                                uint64_t ModuleOffset);
   ErrorOr<DIGlobal> symbolizeData(const std::string &ModuleName,
                                   uint64_t ModuleOffset);
+  /// \brief Release all the cached modules and object files. Must not run
+  /// concurrently with a query.
   void flush();
   static std::string DemangleName(const std::string &Name,
                                   const SymbolizableModule *ModInfo);
@@ -63,8 +75,21 @@ private:
   // corresponding debug info. These objects can be the same.
   typedef std::pair<ObjectFile*, ObjectFile*> ObjectPair;
 
-  ErrorOr<SymbolizableModule *>
+  /// \brief A cached module. The entry stays alive while a query uses it,
+  /// even if it is evicted from the cache in the meantime.
+  struct ModuleEntry {
+    std::unique_ptr<SymbolizableModule> Info;
+    /// Serializes the queries on Info.
+    sys::Mutex Lock;
+    /// Position of the module in ModuleLRU.
+    std::list<std::string>::iterator LRUPos;
+  };
+
+  ErrorOr<std::shared_ptr<ModuleEntry>>
   getOrCreateModuleInfo(const std::string &ModuleName);
+  /// \brief Release the least recently used modules until at most
+  /// Opts.MaxOpenModules are left.
+  void evictModules();
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
@@ -82,7 +107,14 @@ private:
   ErrorOr<ObjectFile *> getOrCreateObject(const std::string &Path,
                                           const std::string &ArchName);
 
-  std::map<std::string, ErrorOr<std::unique_ptr<SymbolizableModule>>> Modules;
+  /// \brief Protects all the caches below. Held while a module is created.
+  sys::Mutex CacheLock;
+
+  std::map<std::string, ErrorOr<std::shared_ptr<ModuleEntry>>> Modules;
+
+  /// \brief Names of the successfully created modules, most recently used
+  /// first.
+  std::list<std::string> ModuleLRU;
 
   /// \brief Contains cached results of getOrCreateObjectPair().
   std::map<std::pair<std::string, std::string>, ErrorOr<ObjectPair>>
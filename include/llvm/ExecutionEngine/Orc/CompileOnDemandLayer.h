@@ -19,9 +19,14 @@
 #include "LambdaResolver.h"
 #include "LogicalDylib.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include <atomic>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
 
 #include "llvm/Support/Debug.h"
@@ -36,6 +41,11 @@ namespace orc {
 /// added to the layer below. When a stub is called it triggers the extraction
 /// of the function body from the original module. The extracted body is then
 /// compiled and executed.
+///
+///   With speculative compilation enabled, the direct callees of each compiled
+/// partition are compiled ahead of time on a background thread. All the work
+/// of this layer is serialized under one lock, so the layers below need not
+/// be thread-safe.
 template <typename BaseLayerT,
           typename CompileCallbackMgrT = JITCompileCallbackManager,
           typename IndirectStubsMgrT = IndirectStubsManager>
@@ -176,7 +186,27 @@ public:
       : BaseLayer(BaseLayer),  Partition(Partition),
         CompileCallbackMgr(CallbackMgr),
         CreateIndirectStubsManager(std::move(CreateIndirectStubsManager)),
-        CloneStubsIntoPartitions(CloneStubsIntoPartitions) {}
+        CloneStubsIntoPartitions(CloneStubsIntoPartitions),
+        CancelSpeculation(false) {}
+
+  ~CompileOnDemandLayer() {
+    // Drop the pending speculative compiles; the pool waits for the running
+    // one when it is destroyed, before the logical dylibs are.
+    CancelSpeculation = true;
+  }
+
+  /// @brief Compile the functions called by each compiled partition ahead of
+  ///        time, on a background thread.
+  ///
+  ///   The program then usually finds its next functions compiled when it
+  /// calls them, instead of waiting for the compiler. Only direct calls to
+  /// functions defined in the same module are followed, one level deep. The
+  /// resolvers given to addModuleSet may be called from the background
+  /// thread.
+  void enableSpeculativeCompilation() {
+    if (!SpeculationPool)
+      SpeculationPool = llvm::make_unique<ThreadPool>(1);
+  }
 
   /// @brief Add a module to the compile-on-demand layer.
   template <typename ModuleSetT, typename MemoryManagerPtrT,
@@ -184,6 +214,7 @@ public:
   ModuleSetHandleT addModuleSet(ModuleSetT Ms,
                                 MemoryManagerPtrT MemMgr,
                                 SymbolResolverPtrT Resolver) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
 
     LogicalDylibs.push_back(CODLogicalDylib(BaseLayer));
     auto &LDResources = LogicalDylibs.back().getDylibResources();
@@ -217,6 +248,15 @@ public:
   ///   This will remove all modules in the layers below that were derived from
   /// the module represented by H.
   void removeModuleSet(ModuleSetHandleT H) {
+    // The pending speculative compiles may refer to H: drop them. This drops
+    // those of the other module sets too; their functions are compiled on
+    // first call instead.
+    if (SpeculationPool) {
+      CancelSpeculation = true;
+      SpeculationPool->wait();
+      CancelSpeculation = false;
+    }
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
     LogicalDylibs.erase(H);
   }
 
@@ -225,6 +265,7 @@ public:
   /// @param ExportedSymbolsOnly If true, search only for exported symbols.
   /// @return A handle for the given named symbol, if it exists.
   JITSymbol findSymbol(StringRef Name, bool ExportedSymbolsOnly) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
     for (auto LDI = LogicalDylibs.begin(), LDE = LogicalDylibs.end();
          LDI != LDE; ++LDI)
       if (auto Symbol = findSymbolIn(LDI, Name, ExportedSymbolsOnly))
@@ -236,9 +277,25 @@ public:
   ///        below this one.
   JITSymbol findSymbolIn(ModuleSetHandleT H, const std::string &Name,
                          bool ExportedSymbolsOnly) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
     return H->findSymbol(Name, ExportedSymbolsOnly);
   }
 
+  /// @brief Point the stub for the function FuncName at FnBodyAddr.
+  ///
+  ///   This lets a client replace a compiled function, e.g. with a more
+  /// optimized version. The stub pointer is written with a single store, so
+  /// threads calling through the stub concurrently get either body.
+  /// @return true if a stub named FuncName was found and updated.
+  bool updatePointer(const std::string &FuncName, TargetAddress FnBodyAddr) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
+    for (auto &LD : LogicalDylibs)
+      if (auto *LMResources =
+              LD.getLogicalModuleResourcesForSymbol(FuncName, false))
+        return !LMResources->StubsMgr->updatePointer(FuncName, FnBodyAddr);
+    return false;
+  }
+
 private:
 
   template <typename ModulePtrT>
@@ -380,18 +437,42 @@ private:
 
   TargetAddress extractAndCompile(CODLogicalDylib &LD,
                                   LogicalModuleHandle LMH,
-                                  Function &F) {
+                                  Function &F, bool Speculative = false) {
+    std::lock_guard<std::recursive_mutex> Lock(LayerMutex);
     auto &LMResources = LD.getLogicalModuleResources(LMH);
     Module &SrcM = LMResources.SourceModule->getResource();
 
-    // If F is a declaration we must already have compiled it.
-    if (F.isDeclaration())
-      return 0;
-
     // Grab the name of the function being called here.
     std::string CalledFnName = mangle(F.getName(), SrcM.getDataLayout());
 
+    // If F is a declaration we must already have compiled it, maybe
+    // speculatively while the program was on its way to the stub. The stub
+    // now leads to the body.
+    if (F.isDeclaration()) {
+      if (Speculative)
+        return 0;
+      return LMResources.StubsMgr->findStub(CalledFnName, false).getAddress();
+    }
+
     auto Part = Partition(F);
+
+    // The bodies are about to move out of SrcM: look for the likely next
+    // partitions now.
+    SetVector<Function *> LikelyNext;
+    if (SpeculationPool && !Speculative)
+      for (auto *SubF : Part)
+        for (auto &BB : *SubF)
+          for (auto &I : BB) {
+            CallSite CS(&I);
+            if (!CS)
+              continue;
+            auto *Callee = dyn_cast<Function>(
+                CS.getCalledValue()->stripPointerCasts());
+            if (Callee && !Callee->isDeclaration() &&
+                Callee->getParent() == &SrcM && !Part.count(Callee))
+              LikelyNext.insert(Callee);
+          }
+
     auto PartH = emitPartition(LD, LMH, Part);
 
     TargetAddress CalledAddr = 0;
@@ -412,6 +493,12 @@ private:
         return 0;
     }
 
+    for (auto *Callee : LikelyNext)
+      SpeculationPool->async([this, &LD, LMH, Callee]() {
+        if (!CancelSpeculation)
+          extractAndCompile(LD, LMH, *Callee, /*Speculative=*/true);
+      });
+
     return CalledAddr;
   }
 
@@ -502,8 +589,14 @@ private:
   CompileCallbackMgrT &CompileCallbackMgr;
   IndirectStubsManagerBuilderT CreateIndirectStubsManager;
 
+  /// Serializes the work of the layer, including the speculative compiles.
+  std::recursive_mutex LayerMutex;
   LogicalDylibList LogicalDylibs;
   bool CloneStubsIntoPartitions;
+
+  std::atomic<bool> CancelSpeculation;
+  /// Declared last so that it is destroyed, and joined, first.
+  std::unique_ptr<ThreadPool> SpeculationPool;
 };
 
 } // End namespace orc.
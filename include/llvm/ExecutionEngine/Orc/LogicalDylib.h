@@ -121,6 +121,16 @@ public:
     return nullptr;
   }
 
+  LogicalModuleResources*
+  getLogicalModuleResourcesForSymbol(const std::string &Name,
+                                     bool ExportedSymbolsOnly) {
+    for (auto LMI = LogicalModules.begin(), LME = LogicalModules.end();
+         LMI != LME; ++LMI)
+      if (auto Sym = LMI->Resources.findSymbol(Name, ExportedSymbolsOnly))
+        return &LMI->Resources;
+    return nullptr;
+  }
+
   LogicalDylibResources& getDylibResources() { return DylibResources; }
 
 protected:
@@ -0,0 +1,67 @@
+//===- PersistentObjectCache.h - On-disk cache keyed by IR hash -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Defines an ObjectCache that stores compiled objects in a directory, keyed by
+// a hash of the IR they were compiled from.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/Mutex.h"
+#include <string>
+
+namespace llvm {
+namespace orc {
+
+/// @brief ObjectCache that persists objects on disk.
+///
+///   Objects are stored in CacheDir under the MD5 hash of the textual IR of
+/// the module they were compiled from, so unlike caches keyed by module name,
+/// an object is only reused for identical IR. This makes the cache usable for
+/// the partitions of the CompileOnDemandLayer, whose names do not change when
+/// the code does. Modules that embed run-time addresses (such as the stub
+/// addresses in the CompileOnDemandLayer's globals module) hash differently on
+/// each run: they are not cached at all, so they don't leave an entry behind
+/// on every run.
+///
+///   The Signature is hashed along with the IR. It must describe everything
+/// else that affects the generated code: target triple, CPU, features,
+/// optimization level...
+///
+///   The cache may be shared by several threads and processes: entries are
+/// written to a temporary file and renamed into place.
+class PersistentObjectCache : public ObjectCache {
+public:
+  PersistentObjectCache(std::string CacheDir, std::string Signature = "");
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  /// @brief Return the path of the cache entry for M.
+  std::string getCachePath(const Module &M) const;
+
+private:
+  std::string CacheDir;
+  std::string Signature;
+
+  /// Paths computed by getObject for modules that missed the cache. Code
+  /// generation may modify the IR, so the hash is not recomputed when the
+  /// object is handed back to notifyObjectCompiled.
+  sys::Mutex PendingLock;
+  DenseMap<const Module *, std::string> PendingPaths;
+};
+
+} // End namespace orc.
+} // End namespace llvm.
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
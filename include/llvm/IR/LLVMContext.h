@@ -193,6 +193,18 @@ public:
   /// any global mutex or cannot block the execution in another LLVM context.
   void yield();
 
+  /// \brief Make the uniquing of constants, types, attributes and metadata safe
+  /// for several threads using this context at the same time.
+  ///
+  /// The uniquing tables, and the table of value names, are then guarded by one
+  /// lock per kind of entity. Only the lookups and insertions in these tables
+  /// are synchronized: the use lists of the shared values, the value handles
+  /// and the metadata attachments are not, so the threads must still not add
+  /// or remove users of a same value concurrently. This must be set before the
+  /// context is shared.
+  void setThreadSafeUniquing(bool Enable);
+  bool hasThreadSafeUniquing() const;
+
   /// emitError - Emit an error message to the currently installed error handler
   /// with optional location information.  This function returns, so code should
   /// be prepared to drop the erroneous construct on the floor and "not crash".
@@ -20,7 +20,9 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Pass.h"
+#include <functional>
 #include <map>
+#include <string>
 #include <vector>
 
 //===----------------------------------------------------------------------===//
@@ -93,6 +95,8 @@
 #include "llvm/Support/PrettyStackTrace.h"
 
 namespace llvm {
+  class BasicBlock;
+  class Function;
   class Module;
   class Pass;
   class StringRef;
@@ -503,6 +507,32 @@ public:
 };
 
 Timer *getPassTimer(Pass *);
+
+/// If -pass-trace is enabled, record the execution of a pass from the
+/// construction to the destruction of the region, along with the name of the
+/// IR unit it runs on and the instruction count of that unit before and after.
+class PassTraceRegion {
+  Pass *P;
+  std::string IRName;
+  const char *Category;
+  std::function<unsigned()> CountInstructions;
+  uint64_t Start;
+  unsigned InstCountBefore;
+
+  PassTraceRegion(const PassTraceRegion &) = delete;
+  void operator=(const PassTraceRegion &) = delete;
+
+public:
+  PassTraceRegion(Pass *P, StringRef IRName, const char *Category,
+                  std::function<unsigned()> CountInstructions);
+  PassTraceRegion(Pass *P, Module &M);
+  PassTraceRegion(Pass *P, Function &F);
+  /// For passes running on a part of \p F, such as a loop or a region: the
+  /// instruction count is the one of the whole function.
+  PassTraceRegion(Pass *P, Function &F, StringRef IRName, const char *Category);
+  PassTraceRegion(Pass *P, BasicBlock &BB);
+  ~PassTraceRegion();
+};
 }
 
 #endif
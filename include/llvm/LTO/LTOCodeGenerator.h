@@ -52,6 +52,7 @@ namespace llvm {
   class Linker;
   class Mangler;
   class MemoryBuffer;
+  class PassManagerBuilder;
   class TargetLibraryInfo;
   class TargetMachine;
   class raw_ostream;
@@ -105,6 +106,15 @@ struct LTOCodeGenerator {
 
   void addMustPreserveSymbol(StringRef Sym) { MustPreserveSymbols[Sym] = 1; }
 
+  /// Set the number of threads running the scalar optimizations.
+  ///
+  /// When greater than one, optimize() runs the interprocedural passes on the
+  /// merged module, then splits it into as many partitions, each one in its
+  /// own context, runs the scalar passes on the partitions in parallel and
+  /// links them back together before the final whole program passes. The
+  /// diagnostics of the scalar passes are not reported in this mode.
+  void setOptParallelism(unsigned Threads) { OptParallelism = Threads; }
+
   /// Pass options to the driver and optimization passes.
   ///
   /// These options are not necessarily for debugging purpose (the function
@@ -172,6 +182,8 @@ private:
 
   bool compileOptimizedToFile(const char **Name);
   void restoreLinkageForExternals();
+  bool canOptimizeInParallel();
+  void optimizeScalarInParallel(PassManagerBuilder &PMB);
   void applyScopeRestrictions();
   void applyRestriction(GlobalValue &GV, ArrayRef<StringRef> Libcalls,
                         std::vector<const char *> &MustPreserveList,
@@ -205,6 +217,7 @@ private:
   TargetOptions Options;
   CodeGenOpt::Level CGOptLevel = CodeGenOpt::Default;
   unsigned OptLevel = 2;
+  unsigned OptParallelism = 1;
   lto_diagnostic_handler_t DiagHandler = nullptr;
   void *DiagContext = nullptr;
   bool ShouldInternalize = true;
@@ -0,0 +1,181 @@
+//===-ThinLTOCodeGenerator.h - LLVM Link Time Optimizer -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the ThinLTOCodeGenerator class, similar to the
+// LTOCodeGenerator but for the ThinLTO scheme. It provides an interface for
+// linker plugin and tools to drive the whole ThinLTO pipeline: combined index
+// creation, cross-module importing, optimization and code generation, with
+// every module processed independently on a thread pool.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LTO_THINLTOCODEGENERATOR_H
+#define LLVM_LTO_THINLTOCODEGENERATOR_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Target/TargetOptions.h"
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class FunctionInfoIndex;
+class LLVMContext;
+class Module;
+class TargetMachine;
+
+/// Helper to gather options relevant to the target machine creation. Every
+/// backend thread creates its own TargetMachine from it.
+struct TargetMachineBuilder {
+  Triple TheTriple;
+  std::string MCpu;
+  std::string MAttr;
+  TargetOptions Options;
+  Reloc::Model RelocModel = Reloc::Default;
+  CodeGenOpt::Level CGOptLevel = CodeGenOpt::Default;
+
+  std::unique_ptr<TargetMachine> create() const;
+};
+
+/// This class defines an interface similar to the LTOCodeGenerator, but
+/// adapted for ThinLTO processing.
+///
+/// The ThinLTOCodeGenerator is not intended to be reused for multiple
+/// compilation: the model is that the client adds modules to the generator
+/// and asks to perform the ThinLTO optimizations / codegen, and finally
+/// destroys the codegenerator.
+class ThinLTOCodeGenerator {
+public:
+  /// Add given module to the code generator. The buffer referenced by \p Data
+  /// must outlive the generator.
+  void addModule(StringRef Identifier, StringRef Data);
+
+  /// Process all the modules that were added to the code generator in
+  /// parallel: link the combined index, then import, optimize and codegen
+  /// each module independently.
+  ///
+  /// Client can access the resulting object files using getProducedBinaries()
+  void run();
+
+  /// Return the "in memory" binaries produced by the code generator, one for
+  /// every module that was added, in the same order.
+  std::vector<SmallVector<char, 0>> &getProducedBinaries() {
+    return ProducedBinaries;
+  }
+
+  /// \defgroup Cache controlling options
+  ///
+  /// These entry points control the ThinLTO cache. The cache is intended to
+  /// support incremental build, and thus needs to be persistent across builds.
+  /// The client enables the cache by supplying a path to an existing
+  /// directory. The code generator will use this to store objects files that
+  /// may be reused during a subsequent build. Several processes can share the
+  /// same cache directory.
+  /// To avoid filling the disk space, a few knobs are provided:
+  ///  - The pruning interval limits the frequency at which the garbage
+  ///    collector will try to scan the cache directory to prune it from
+  ///    expired entries. Setting to 0 forces a scan at every run.
+  ///  - The pruning expiration time indicates to the garbage collector how
+  ///    old an entry needs to be to be removed.
+  ///  - Finally, the garbage collector can be instructed to prune the cache
+  ///    until the total size of its entries is below a given number of bytes.
+  /// @{
+
+  struct CachingOptions {
+    std::string Path;
+    unsigned PruningInterval = 1200; // 20 minutes.
+    unsigned Expiration = 7 * 24 * 3600; // One week.
+    uint64_t MaxSize = 0; // No size limit.
+  };
+
+  /// Provide a path to a directory where to store the cached files for
+  /// incremental build.
+  void setCacheDir(std::string Path) { CacheOptions.Path = std::move(Path); }
+
+  /// Cache policy: interval (seconds) between two prunes of the cache.
+  void setCachePruningInterval(unsigned Interval) {
+    CacheOptions.PruningInterval = Interval;
+  }
+
+  /// Cache policy: expiration (in seconds) for an entry. A value of 0 disables
+  /// the expiration.
+  void setCacheEntryExpiration(unsigned Expiration) {
+    CacheOptions.Expiration = Expiration;
+  }
+
+  /// Cache policy: the maximum size in bytes of the cache directory. A value
+  /// of 0 disables the size limit.
+  void setCacheMaxSize(uint64_t MaxSize) { CacheOptions.MaxSize = MaxSize; }
+
+  /// @}
+
+  /// \defgroup Options setters
+  /// @{
+
+  /// Set the number of threads used for the backends. A value of 0 defaults
+  /// to the number of hardware threads.
+  void setThreadCount(unsigned Count) { ThreadCount = Count; }
+
+  /// Set the target options.
+  void setTargetOptions(TargetOptions Options) {
+    TMBuilder.Options = std::move(Options);
+  }
+
+  /// CPU to use to initialize the TargetMachine.
+  void setCpu(std::string Cpu) { TMBuilder.MCpu = std::move(Cpu); }
+
+  /// Subtarget attributes.
+  void setAttr(std::string MAttr) { TMBuilder.MAttr = std::move(MAttr); }
+
+  /// CodeModel.
+  void setCodePICModel(Reloc::Model Model) { TMBuilder.RelocModel = Model; }
+
+  /// CodeGen optimization level.
+  void setCodeGenOptLevel(CodeGenOpt::Level CGOptLevel) {
+    TMBuilder.CGOptLevel = CGOptLevel;
+  }
+
+  /// IR optimization level: from 0 to 3.
+  void setOptLevel(unsigned NewOptLevel) {
+    OptLevel = (NewOptLevel > 3) ? 3 : NewOptLevel;
+  }
+
+  /// @}
+
+  /// Produce the combined function index from all the bitcode files added
+  /// using addModule(). Modules without a summary are skipped. Returns nullptr
+  /// if a summary can't be read.
+  std::unique_ptr<FunctionInfoIndex> linkCombinedIndex();
+
+private:
+  /// Helper factory to build a TargetMachine.
+  TargetMachineBuilder TMBuilder;
+
+  /// Options controlling the on-disk cache of the backends.
+  CachingOptions CacheOptions;
+
+  /// Vector holding the in-memory buffer containing the produced binaries.
+  std::vector<SmallVector<char, 0>> ProducedBinaries;
+
+  /// Vector holding the input buffers containing the bitcode modules to
+  /// process.
+  std::vector<MemoryBufferRef> Modules;
+
+  /// Number of backend threads, 0 means std::thread::hardware_concurrency().
+  unsigned ThreadCount = 0;
+
+  /// IR Optimization Level [0-3].
+  unsigned OptLevel = 3;
+};
+}
+#endif
@@ -118,6 +118,10 @@ public:
   /// \param [out] Res On return, the relaxed instruction.
   virtual void relaxInstruction(const MCInst &Inst, MCInst &Res) const = 0;
 
+  /// Check whether the relaxation interfaces and processFixupValue may be
+  /// called concurrently for fragments of different sections.
+  virtual bool allowsParallelRelaxation() const { return false; }
+
   /// @}
 
   /// Returns the minimum size of a nop in bytes on this target. The assembler
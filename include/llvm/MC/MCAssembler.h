@@ -22,6 +22,7 @@
 #include "llvm/MC/MCLinkerOptimizationHint.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/Support/Mutex.h"
 
 namespace llvm {
 class raw_ostream;
@@ -130,6 +131,14 @@ private:
   /// By default it's 0, which means bundling is disabled.
   unsigned BundleAlignSize;
 
+  /// The number of threads used to relax independent sections and to build
+  /// the string table, 0 or 1 when the layout is serial.
+  unsigned LayoutThreads;
+
+  /// Serializes the code emitter, which may allocate expressions in the
+  /// context, when instructions are relaxed in parallel.
+  sys::Mutex EmitterLock;
+
   unsigned RelaxAll : 1;
   unsigned SubsectionsViaSymbols : 1;
   unsigned IncrementalLinkerCompatible : 1;
@@ -182,6 +191,15 @@ private:
   /// if any offsets were adjusted.
   bool layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec);
 
+  /// \brief Check whether the sizes of the fragments of \p Sec only depend on
+  /// the layout of \p Sec itself, so that it can be relaxed concurrently with
+  /// the other sections.
+  bool canLayoutSectionIndependently(const MCSection &Sec) const;
+
+  /// \brief Relax the sections which don't depend on each other in parallel,
+  /// before the serial layout iterations handle the remaining ones.
+  void layoutIndependentSections(MCAsmLayout &Layout);
+
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
   bool relaxLEB(MCAsmLayout &Layout, MCLEBFragment &IF);
@@ -286,6 +304,9 @@ public:
   bool getRelaxAll() const { return RelaxAll; }
   void setRelaxAll(bool Value) { RelaxAll = Value; }
 
+  unsigned getLayoutThreads() const { return LayoutThreads; }
+  void setLayoutThreads(unsigned Threads) { LayoutThreads = Threads; }
+
   bool isBundlingEnabled() const { return BundleAlignSize != 0; }
 
   unsigned getBundleAlignSize() const { return BundleAlignSize; }
@@ -37,6 +37,10 @@ public:
   bool ShowMCInst : 1;
   bool AsmVerbose : 1;
   int DwarfVersion;
+  /// Number of threads the assembler may use to relax the sections of an
+  /// object file which don't depend on each other and to build its string
+  /// table. 0 or 1 work serially.
+  unsigned MCLayoutThreads;
   /// getABIName - If this returns a non-empty string this represents the
   /// textual name of the ABI that we want the backend to use, e.g. o32, or
   /// aapcs-linux.
@@ -59,6 +63,7 @@ inline bool operator==(const MCTargetOptions &LHS, const MCTargetOptions &RHS) {
           ARE_EQUAL(ShowMCInst) &&
           ARE_EQUAL(AsmVerbose) &&
           ARE_EQUAL(DwarfVersion) &&
+          ARE_EQUAL(MCLayoutThreads) &&
           ARE_EQUAL(ABIName));
 #undef ARE_EQUAL
 }
@@ -26,6 +26,7 @@ private:
   DenseMap<StringRef, size_t> StringIndexMap;
   size_t Size = 0;
   Kind K;
+  unsigned Parallelism = 1;
 
   void finalizeStringTable(bool Optimize);
 
@@ -37,6 +38,11 @@ public:
   /// Can only be used before the table is finalized.
   size_t add(StringRef S);
 
+  /// \brief Use up to \p Threads threads to sort the strings for tail merging
+  /// in finalize(). Only large tables are sorted in parallel, and the result
+  /// doesn't depend on the number of threads.
+  void setParallelism(unsigned Threads) { Parallelism = Threads; }
+
   /// \brief Analyze the strings and build the final table. No more strings can
   /// be added after this point.
   void finalize();
@@ -33,6 +33,27 @@ class PassBuilder {
   TargetMachine *TM;
 
 public:
+  /// \brief LLVM-provided high-level optimization levels.
+  ///
+  /// This enumerates the LLVM-provided high-level optimization levels, which
+  /// correspond to the "-O[0123]" options of the frontends and of \c
+  /// PassManagerBuilder.
+  enum OptimizationLevel {
+    /// Disable as many optimizations as possible.
+    O0,
+
+    /// Optimize quickly without destroying debuggability.
+    O1,
+
+    /// Optimize for fast execution as much as possible without triggering
+    /// significant incremental compile time or code size growth.
+    O2,
+
+    /// Optimize for fast execution as much as possible, regardless of the
+    /// compile time or code size growth.
+    O3
+  };
+
   explicit PassBuilder(TargetMachine *TM = nullptr) : TM(TM) {}
 
   /// \brief Registers all available module analysis passes.
@@ -56,6 +77,28 @@ public:
   /// still manually register any additional analyses.
   void registerFunctionAnalyses(FunctionAnalysisManager &FAM);
 
+  /// \brief Construct the core LLVM function canonicalization and
+  /// simplification pipeline.
+  ///
+  /// This is the function pipeline \c PassManagerBuilder runs on every
+  /// function at the given optimization level, restricted to the passes which
+  /// are available in the new pass manager. They are ordered so that the
+  /// passes which don't change the CFG keep the dominator tree and the loop
+  /// info alive from one to the next.
+  ///
+  /// Note that \p Level cannot be `O0` here.
+  FunctionPassManager
+  buildFunctionSimplificationPipeline(OptimizationLevel Level,
+                                      bool DebugLogging = false);
+
+  /// \brief Build a per-module default optimization pipeline.
+  ///
+  /// This provides a good default optimization pipeline for per-module
+  /// optimization without any link-time optimization. It is parsed from the
+  /// "default<O1>", "default<O2>" and "default<O3>" pipeline names.
+  ModulePassManager buildPerModuleDefaultPipeline(OptimizationLevel Level,
+                                                  bool DebugLogging = false);
+
   /// \brief Parse a textual pass pipeline description into a \c ModulePassManager.
   ///
   /// The format of the textual pass pipeline description looks something like:
@@ -84,11 +127,15 @@ public:
   /// the sequence of passes aren't all the exact same kind of pass, it will be
   /// an error. You cannot mix different levels implicitly, you must explicitly
   /// form a pass manager in which to nest passes.
+  ///
+  /// The default optimization pipelines are named "default<O0>" to
+  /// "default<O3>", they can be used as any other module pass.
   bool parsePassPipeline(ModulePassManager &MPM, StringRef PipelineText,
                          bool VerifyEachPass = true, bool DebugLogging = false);
 
 private:
-  bool parseModulePassName(ModulePassManager &MPM, StringRef Name);
+  bool parseModulePassName(ModulePassManager &MPM, StringRef Name,
+                           bool DebugLogging);
   bool parseCGSCCPassName(CGSCCPassManager &CGPM, StringRef Name);
   bool parseFunctionPassName(FunctionPassManager &FPM, StringRef Name);
   bool parseFunctionPassPipeline(FunctionPassManager &FPM,
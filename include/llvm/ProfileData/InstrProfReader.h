@@ -339,6 +339,21 @@ private:
   /// Profile summary data.
   std::unique_ptr<ProfileSummary> Summary;
 
+  /// A lookup in the on-disk hash table decodes every record of the function,
+  /// and leaves them in a buffer that the next lookup overwrites. Keep the
+  /// records of the recently looked up functions in a small direct-mapped
+  /// cache, as clients tend to query the same function several times.
+  struct CachedFunction {
+    std::string FuncName;
+    std::vector<InstrProfRecord> Records;
+  };
+  static const unsigned RecordCacheSize = 16;
+  CachedFunction RecordCache[RecordCacheSize];
+
+  /// Return the records of the function FuncName, from the cache if possible.
+  std::error_code getRecords(StringRef FuncName,
+                             ArrayRef<InstrProfRecord> &Data);
+
   IndexedInstrProfReader(const IndexedInstrProfReader &) = delete;
   IndexedInstrProfReader &operator=(const IndexedInstrProfReader &) = delete;
 
@@ -372,7 +387,9 @@ public:
   /// Return the maximum of all known function counts.
   uint64_t getMaximumFunctionCount() { return Summary->getMaxFunctionCount(); }
 
-  /// Factory method to create an indexed reader.
+  /// Factory method to create an indexed reader. The file is memory mapped
+  /// when possible, and the records are only decoded when they are looked up,
+  /// so the cost of opening a large profile doesn't depend on its size.
   static ErrorOr<std::unique_ptr<IndexedInstrProfReader>>
   create(std::string Path);
 
@@ -0,0 +1,71 @@
+//=- CachePruning.h - Helper to manage the pruning of a cache dir -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements pruning of a directory intended for cache storage,
+// using various policies: a minimum interval between two prunings, an
+// expiration time for entries and a maximum total size.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_CACHE_PRUNING_H
+#define LLVM_SUPPORT_CACHE_PRUNING_H
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+
+/// Handle pruning a directory provided a path and some options to control what
+/// to prune. Several processes may share the same cache directory: the pruning
+/// itself is serialized with a lock file so that only one of them walks the
+/// directory at a time.
+class CachePruning {
+public:
+  /// Prepare to prune \p Path.
+  CachePruning(StringRef Path) : Path(Path) {}
+
+  /// Define the pruning interval. This is intended to be used to avoid
+  /// scanning the directory too often. It does not impact the decision of
+  /// which file to prune. A value of 0 forces the scan to occur.
+  CachePruning &setPruningInterval(unsigned PruningInterval) {
+    Interval = PruningInterval;
+    return *this;
+  }
+
+  /// Define the expiration for a file. When a file hasn't been accessed for
+  /// \p ExpireAfter seconds, it is removed from the cache. A value of 0
+  /// disables the expiration-based pruning.
+  CachePruning &setEntryExpiration(unsigned ExpireAfter) {
+    Expiration = ExpireAfter;
+    return *this;
+  }
+
+  /// Define the maximum size of the cache directory in bytes. When the sum of
+  /// the sizes of the entries exceeds this value, the least recently used
+  /// entries are removed first. A value of 0 disables the size-based pruning.
+  CachePruning &setMaxSize(uint64_t MaxSizeInBytes) {
+    MaxSize = MaxSizeInBytes;
+    return *this;
+  }
+
+  /// Peform pruning using the supplied options, returns true if pruning
+  /// occured, i.e. if PruningInterval was expired.
+  bool prune();
+
+private:
+  // Options that matches the setters above.
+  SmallString<128> Path;
+  unsigned Expiration = 0;
+  unsigned Interval = 0;
+  uint64_t MaxSize = 0;
+};
+
+} // namespace llvm
+
+#endif
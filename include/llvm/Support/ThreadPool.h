@@ -7,7 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file defines a crude C++11 based thread pool.
+// This file defines a C++11 based work-stealing thread pool.
 //
 //===----------------------------------------------------------------------===//
 
@@ -33,20 +33,29 @@
 #pragma warning(pop)
 #endif
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
-/// The pool keeps a vector of threads alive, waiting on a condition variable
-/// for some work to become available.
+/// Every thread of the pool owns a deque of tasks. Tasks submitted from a
+/// thread of the pool are pushed on its own deque and popped in LIFO order,
+/// tasks submitted from outside the pool are distributed round-robin. A thread
+/// that runs out of work steals the oldest task from the deque of another
+/// thread, and sleeps on a condition variable when no work is available.
+///
+/// Tasks that spawn sub-tasks and need to wait on their completion should use
+/// a ThreadPool::TaskGroup: waiting on a group from a thread of the pool runs
+/// pending tasks instead of blocking, so it doesn't deadlock the pool.
 class ThreadPool {
 public:
 #ifndef _MSC_VER
@@ -61,6 +70,44 @@ public:
   using PackagedTaskTy = std::packaged_task<bool(bool)>;
 #endif
 
+  /// A set of tasks submitted to a pool that can be waited on independently of
+  /// the other tasks of the pool. This is intended for a task that spawns
+  /// children and waits on them.
+  class TaskGroup {
+  public:
+    explicit TaskGroup(ThreadPool &Pool) : Pool(Pool), PendingTasks(0) {}
+
+    /// Blocking destructor: wait for all the tasks of the group to complete.
+    ~TaskGroup() { wait(); }
+
+    /// Asynchronous submission of a task to the group.
+    template <typename Function, typename... Args>
+    inline void async(Function &&F, Args &&... ArgList) {
+      asyncImpl(
+          std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...));
+    }
+
+    /// Asynchronous submission of a task to the group.
+    template <typename Function> inline void async(Function &&F) {
+      asyncImpl(std::forward<Function>(F));
+    }
+
+    /// Wait for all the tasks of the group to complete. When called from a
+    /// thread of the pool, the thread runs pending tasks in the meantime.
+    void wait();
+
+  private:
+    void asyncImpl(std::function<void()> Task);
+
+    /// Mark one task of the group as completed.
+    void taskDone();
+
+    ThreadPool &Pool;
+
+    /// Number of tasks of this group that haven't completed yet.
+    std::atomic<unsigned> PendingTasks;
+  };
+
   /// Construct a pool with the number of core available on the system (or
   /// whatever the value returned by std::thread::hardware_concurrency() is).
   ThreadPool();
@@ -100,22 +147,58 @@ public:
 #endif
   }
 
-  /// Blocking wait for all the threads to complete and the queue to be empty.
-  /// It is an error to try to add new tasks while blocking on this call.
+  /// Blocking wait for all the threads to complete and the queues to be empty.
+  /// It is an error to try to add new tasks while blocking on this call, and
+  /// to call it from a task running in the pool (use a TaskGroup instead).
   void wait();
 
 private:
+  /// A deque of tasks owned by one thread of the pool.
+  struct WorkerQueue {
+    std::mutex Lock;
+    std::deque<PackagedTaskTy> Tasks;
+  };
+
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   std::shared_future<VoidTy> asyncImpl(TaskTy F);
 
+  /// Queue a task: on the deque of the calling thread if it belongs to the
+  /// pool, round-robin otherwise.
+  void push(PackagedTaskTy Task);
+
+  /// Pop a task from the deque \p QueueID, or steal one from another deque.
+  /// Returns false if all the deques are empty.
+  bool pop(unsigned QueueID, PackagedTaskTy &Task);
+
+  /// Run a single pending task on the calling thread, if any. Returns false if
+  /// no task was available.
+  bool runOneTask();
+
+  /// Run \p Task and signal its completion.
+  void runTask(PackagedTaskTy &Task);
+
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Tasks waiting for execution in the pool, one deque per thread.
+  std::vector<std::unique_ptr<WorkerQueue>> Queues;
 
-  /// Locking and signaling for accessing the Tasks queue.
+  /// Round-robin counter distributing the tasks submitted from outside.
+  std::atomic<unsigned> NextQueue;
+
+  /// Number of tasks sitting in the deques. It may transiently go negative
+  /// when a task is stolen before its submitter accounted for it.
+  std::atomic<int> QueuedTasks;
+
+  /// Number of tasks submitted and not completed yet, queued or running.
+  std::atomic<unsigned> UnfinishedTasks;
+
+  /// Number of threads waiting on QueueCondition for tasks. Submitting a task
+  /// only takes QueueLock when there is one to wake up.
+  std::atomic<unsigned> IdleThreads;
+
+  /// Locking and signaling for idle threads waiting for tasks.
   std::mutex QueueLock;
   std::condition_variable QueueCondition;
 
@@ -123,9 +206,6 @@ private:
   std::mutex CompletionLock;
   std::condition_variable CompletionCondition;
 
-  /// Keep track of the number of thread actually busy
-  std::atomic<unsigned> ActiveThreads;
-
 #if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
   bool EnableFlag;
@@ -137,6 +137,22 @@ enum {
 
   /// Generic ADD instruction. This is an integer add.
   G_ADD = PRE_ISEL_GENERIC_OPCODE_START,
+
+  /// Generic SUB instruction. This is an integer sub.
+  G_SUB,
+
+  /// Generic bitwise AND instruction.
+  G_AND,
+
+  /// Generic bitwise OR instruction.
+  G_OR,
+
+  /// Generic bitwise XOR instruction.
+  G_XOR,
+
+  /// Generic unconditional branch instruction.
+  G_BR,
+
   // TODO: Add more generic opcodes as we move along.
   // FIXME: Right now, we have to manually add any new opcode in
   // CodeGenTarget.cpp for TableGen to pick them up.
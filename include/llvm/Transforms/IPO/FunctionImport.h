@@ -11,6 +11,7 @@
 #define LLVM_FUNCTIONIMPORT_H
 
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include <functional>
 
 namespace llvm {
@@ -29,6 +30,10 @@ class FunctionImporter {
   std::function<std::unique_ptr<Module>(StringRef Identifier)> ModuleLoader;
 
 public:
+  /// The names of the functions to import, keyed by the identifier of the
+  /// module they are imported from.
+  typedef StringMap<StringSet<>> ImportMapTy;
+
   /// Create a Function Importer.
   FunctionImporter(
       const FunctionInfoIndex &Index,
@@ -37,6 +42,11 @@ public:
 
   /// Import functions in Module \p M based on the summary informations.
   bool importFunctions(Module &M);
+
+  /// Compute the list of functions that importFunctions() would import in
+  /// Module \p M, without linking them. This is intended to let clients
+  /// identify the inputs of a ThinLTO backend, for instance to key a cache.
+  void computeImportList(Module &M, ImportMapTy &ImportList);
 };
 }
 
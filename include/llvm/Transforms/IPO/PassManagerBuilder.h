@@ -157,7 +157,9 @@ private:
                          legacy::PassManagerBase &PM) const;
   void addInitialAliasAnalysisPasses(legacy::PassManagerBase &PM) const;
   void addLTOOptimizationPasses(legacy::PassManagerBase &PM);
+  void addLTOScalarOptimizationPasses(legacy::PassManagerBase &PM);
   void addLateLTOOptimizationPasses(legacy::PassManagerBase &PM);
+  void addLTOFinalPasses(legacy::PassManagerBase &PM);
   void addPGOInstrPasses(legacy::PassManagerBase &MPM);
 
 public:
@@ -169,6 +171,15 @@ public:
   /// populateModulePassManager - This sets up the primary pass manager.
   void populateModulePassManager(legacy::PassManagerBase &MPM);
   void populateLTOPassManager(legacy::PassManagerBase &PM);
+
+  /// The three steps of the LTO pipeline, which together are equivalent to
+  /// populateLTOPassManager: the interprocedural passes, the scalar passes
+  /// and the final whole program cleanups. The scalar passes only look at the
+  /// functions of the module they run on, so the middle step can be run on
+  /// separate partitions of the module, for instance in parallel.
+  void populateLTOInterproceduralPassManager(legacy::PassManagerBase &PM);
+  void populateLTOScalarPassManager(legacy::PassManagerBase &PM);
+  void populateLTOFinalPassManager(legacy::PassManagerBase &PM);
 };
 
 /// Registers a function for adding a standard set of passes.  This should be
@@ -123,6 +123,19 @@ bool CGPassManager::RunPassOnSCC(Pass *P, CallGraphSCC &CurSCC,
 
     {
       TimeRegion PassTimer(getPassTimer(CGSP));
+      // The SCC is named after its first function, the instruction count is
+      // the one of all its functions.
+      Function *FirstF = (*CurSCC.begin())->getFunction();
+      PassTraceRegion PassTrace(
+          CGSP, FirstF ? FirstF->getName() : "<external node>", "scc",
+          [&CurSCC] {
+            unsigned Count = 0;
+            for (CallGraphNode *CGN : CurSCC)
+              if (Function *F = CGN->getFunction())
+                for (BasicBlock &BB : *F)
+                  Count += BB.size();
+            return Count;
+          });
       Changed = CGSP->runOnSCC(CurSCC);
     }
     
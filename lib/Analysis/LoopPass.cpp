@@ -194,6 +194,8 @@ bool LPPassManager::runOnFunction(Function &F) {
       {
         PassManagerPrettyStackEntry X(P, *CurrentLoop->getHeader());
         TimeRegion PassTimer(getPassTimer(P));
+        PassTraceRegion PassTrace(P, F, CurrentLoop->getHeader()->getName(),
+                                  "loop");
 
         Changed |= P->runOnLoop(CurrentLoop, *this);
       }
@@ -96,6 +96,8 @@ bool RGPassManager::runOnFunction(Function &F) {
         PassManagerPrettyStackEntry X(P, *CurrentRegion->getEntry());
 
         TimeRegion PassTimer(getPassTimer(P));
+        PassTraceRegion PassTrace(P, F, CurrentRegion->getEntry()->getName(),
+                                  "region");
         Changed |= P->runOnRegion(CurrentRegion, *this);
       }
 
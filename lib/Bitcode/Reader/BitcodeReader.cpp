@@ -5202,7 +5202,9 @@ OutOfRecordLoop:
   // Trim the value list down to the size it was before we parsed this function.
   ValueList.shrinkTo(ModuleValueListSize);
   MetadataList.shrinkTo(ModuleMetadataListSize);
-  std::vector<BasicBlock*>().swap(FunctionBBs);
+  // Keep the block table's storage around for the next function body; it is
+  // only released in freeState().
+  FunctionBBs.clear();
   return std::error_code();
 }
 
@@ -12,26 +12,172 @@
 
 #include "llvm/CodeGen/GlobalISel/IRTranslator.h"
 
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/GlobalISel/CallLowering.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetOpcodes.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+#define DEBUG_TYPE "irtranslator"
+
 using namespace llvm;
 
 char IRTranslator::ID = 0;
+INITIALIZE_PASS(IRTranslator, "irtranslator", "IRTranslator LLVM IR -> MI",
+                false, false)
+
+IRTranslator::IRTranslator()
+    : MachineFunctionPass(ID), CLI(nullptr), MRI(nullptr) {
+  initializeIRTranslatorPass(*PassRegistry::getPassRegistry());
+}
 
-bool IRTranslator::translateADD(const Instruction &Inst) {
-  return false;
+unsigned IRTranslator::getOrCreateVReg(const Value &Val) {
+  SmallVector<unsigned, 1> &ValRegs = ValToVRegs[&Val];
+  // Check if this is the first time we see Val.
+  if (ValRegs.empty()) {
+    // Fill ValRegs with the sequence of registers
+    // we need to represent Val.
+    Type *VTy = Val.getType();
+    assert(VTy->isSized() && "Cannot create unsized vreg");
+    assert(!VTy->isAggregateType() && "Not yet implemented");
+    unsigned Size = MIRBuilder.getMF().getDataLayout().getTypeSizeInBits(VTy);
+    unsigned VReg = MRI->createGenericVirtualRegister(Size);
+    ValRegs.push_back(VReg);
+  }
+  assert(ValRegs.size() == 1 &&
+         "We support only one vreg per value at the moment");
+  return ValRegs[0];
 }
 
-bool IRTranslator::translate(const Instruction &) {
-  return false;
+MachineBasicBlock &IRTranslator::getOrCreateBB(const BasicBlock &BB) {
+  MachineBasicBlock *&MBB = BBToMBB[&BB];
+  if (!MBB) {
+    MachineFunction &MF = MIRBuilder.getMF();
+    MBB = MF.CreateMachineBasicBlock(&BB);
+    MF.push_back(MBB);
+  }
+  return *MBB;
 }
 
+bool IRTranslator::translateBinaryOp(unsigned Opcode, const Instruction &Inst) {
+  // Only the scalar integer operations have generic opcodes so far.
+  if (!Inst.getType()->isIntegerTy())
+    return false;
+  // FIXME: Materialize the constant operands through ConstantToSequence.
+  if (isa<Constant>(Inst.getOperand(0)) || isa<Constant>(Inst.getOperand(1)))
+    return false;
+  // Get or create a virtual register for each value.
+  unsigned Op0 = getOrCreateVReg(*Inst.getOperand(0));
+  unsigned Op1 = getOrCreateVReg(*Inst.getOperand(1));
+  unsigned Res = getOrCreateVReg(Inst);
+  MIRBuilder.buildInstr(Opcode, Res, Op0, Op1);
+  return true;
+}
 
-void IRTranslator::finalize() {
+bool IRTranslator::translateBr(const Instruction &Inst) {
+  const BranchInst &BrInst = cast<BranchInst>(Inst);
+  // FIXME: The conditional branches need a generic comparison.
+  if (BrInst.isConditional())
+    return false;
+  const BasicBlock &BrTgt = *BrInst.getSuccessor(0);
+  MachineBasicBlock &TgtBB = getOrCreateBB(BrTgt);
+  MIRBuilder.buildInstr(TargetOpcode::G_BR, TgtBB);
+  // Link successors.
+  MIRBuilder.getMBB().addSuccessor(&TgtBB);
+  return true;
 }
 
-IRTranslator::IRTranslator()
-  : MachineFunctionPass(ID) {
+bool IRTranslator::translateReturn(const Instruction &Inst) {
+  assert(isa<ReturnInst>(Inst) && "Return expected");
+  const Value *Ret = cast<ReturnInst>(Inst).getReturnValue();
+  // FIXME: Materialize the returned constants through ConstantToSequence.
+  if (Ret && isa<Constant>(Ret))
+    return false;
+  // The target may mess up with the insertion point, but
+  // this is not important as a return is the last instruction
+  // of the block anyway.
+  return CLI->lowerReturn(MIRBuilder, Ret, !Ret ? 0 : getOrCreateVReg(*Ret));
+}
+
+bool IRTranslator::translate(const Instruction &Inst) {
+  MIRBuilder.setDebugLoc(Inst.getDebugLoc());
+  switch (Inst.getOpcode()) {
+  // Arithmetic operations.
+  case Instruction::Add:
+    return translateBinaryOp(TargetOpcode::G_ADD, Inst);
+  case Instruction::Sub:
+    return translateBinaryOp(TargetOpcode::G_SUB, Inst);
+  // Bitwise operations.
+  case Instruction::And:
+    return translateBinaryOp(TargetOpcode::G_AND, Inst);
+  case Instruction::Or:
+    return translateBinaryOp(TargetOpcode::G_OR, Inst);
+  case Instruction::Xor:
+    return translateBinaryOp(TargetOpcode::G_XOR, Inst);
+  // Branch operations.
+  case Instruction::Br:
+    return translateBr(Inst);
+  case Instruction::Ret:
+    return translateReturn(Inst);
+  default:
+    return false;
+  }
+}
+
+void IRTranslator::finalize() {
+  // Release the memory used by the different maps we
+  // needed during the translation.
+  ValToVRegs.clear();
+  ConstantToSequence.clear();
+  BBToMBB.clear();
 }
 
 bool IRTranslator::runOnMachineFunction(MachineFunction &MF) {
-  return false;
+  const Function &F = *MF.getFunction();
+  if (F.empty())
+    return false;
+  CLI = MF.getSubtarget().getCallLowering();
+  MRI = &MF.getRegInfo();
+  MIRBuilder.setMF(MF);
+  // Create the machine basic blocks in the order of the IR ones, before the
+  // branches refer to them.
+  for (const BasicBlock &BB : F)
+    getOrCreateBB(BB);
+  MIRBuilder.setMBB(getOrCreateBB(F.front()));
+
+  // Lower the arguments into the virtual registers of the entry block.
+  SmallVector<unsigned, 8> VRegArgs;
+  for (const Argument &Arg : F.args())
+    VRegArgs.push_back(getOrCreateVReg(Arg));
+  bool Succeeded =
+      CLI && CLI->lowerFormalArguments(MIRBuilder, F.getArgumentList(),
+                                       VRegArgs);
+  if (!Succeeded)
+    report_fatal_error("Unable to lower arguments");
+
+  for (const BasicBlock &BB : F) {
+    MachineBasicBlock &MBB = getOrCreateBB(BB);
+    // Set the insertion point of all the following translations to
+    // the end of this basic block.
+    MIRBuilder.setMBB(MBB);
+    for (const Instruction &Inst : BB) {
+      bool Succeeded = translate(Inst);
+      if (!Succeeded) {
+        DEBUG(dbgs() << "Cannot translate: " << Inst << '\n');
+        report_fatal_error("Unable to translate instruction");
+      }
+    }
+  }
+
+  // Now that the MachineFunction is complete, materialize the constants and
+  // release the maps.
+  finalize();
+  return true;
 }
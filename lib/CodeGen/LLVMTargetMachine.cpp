@@ -22,8 +22,10 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCAssembler.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectStreamer.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/Support/CommandLine.h"
@@ -42,6 +44,14 @@ static cl::opt<cl::boolOrDefault>
 EnableFastISelOption("fast-isel", cl::Hidden,
   cl::desc("Enable the \"fast\" instruction selector"));
 
+#ifdef LLVM_BUILD_GLOBAL_ISEL
+static cl::opt<bool>
+    EnableGlobalISel("global-isel", cl::init(false), cl::Hidden,
+                     cl::desc("Enable the \"global\" instruction selector"));
+#else
+static const bool EnableGlobalISel = false;
+#endif
+
 void LLVMTargetMachine::initAsmInfo() {
   MRI = TheTarget.createMCRegInfo(getTargetTriple().str());
   MII = TheTarget.createMCInstrInfo();
@@ -136,7 +146,12 @@ addPassesToGenerateCode(LLVMTargetMachine *TM, PassManagerBase &PM,
     TM->setFastISel(true);
 
   // Ask the target for an isel.
-  if (PassConfig->addInstSelector())
+  if (LLVM_UNLIKELY(EnableGlobalISel)) {
+    // FIXME: The generic machine instructions are not selected yet, only
+    // -stop-after=irtranslator gives a usable output.
+    if (PassConfig->addIRTranslator())
+      return nullptr;
+  } else if (PassConfig->addInstSelector())
     return nullptr;
 
   PassConfig->addMachinePasses();
@@ -209,6 +224,9 @@ bool LLVMTargetMachine::addPassesToEmitFile(
         T, *Context, *MAB, Out, MCE, STI, Options.MCOptions.MCRelaxAll,
         Options.MCOptions.MCIncrementalLinkerCompatible,
         /*DWARFMustBeAtTheEnd*/ true));
+    static_cast<MCObjectStreamer &>(*AsmStreamer)
+        .getAssembler()
+        .setLayoutThreads(Options.MCOptions.MCLayoutThreads);
     break;
   }
   case CGFT_Null:
@@ -206,8 +206,11 @@ void MIRPrinter::convert(yaml::MachineFunction &MF,
     unsigned Reg = TargetRegisterInfo::index2VirtReg(I);
     yaml::VirtualRegisterDefinition VReg;
     VReg.ID = I;
-    VReg.Class =
-        StringRef(TRI->getRegClassName(RegInfo.getRegClass(Reg))).lower();
+    // The generic virtual registers have no register class yet.
+    if (const TargetRegisterClass *RC = RegInfo.getRegClass(Reg))
+      VReg.Class = StringRef(TRI->getRegClassName(RC)).lower();
+    else
+      VReg.Class = std::string("_");
     unsigned PreferredReg = RegInfo.getSimpleHint(Reg);
     if (PreferredReg)
       printReg(PreferredReg, VReg.PreferredRegister, TRI);
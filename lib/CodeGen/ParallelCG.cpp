@@ -16,15 +16,24 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/thread.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
+#include <algorithm>
+#include <queue>
 
 using namespace llvm;
 
+static cl::opt<unsigned> PartitionsPerOutput(
+    "split-codegen-partitions-per-output", cl::Hidden, cl::init(1),
+    cl::desc("Split the module into this many partitions per output stream "
+             "and balance them across the outputs by estimated cost"));
+
 static void codegen(Module *M, llvm::raw_pwrite_stream &OS,
                     const Target *TheTarget, StringRef CPU, StringRef Features,
                     const TargetOptions &Options, Reloc::Model RM,
@@ -39,6 +48,112 @@ static void codegen(Module *M, llvm::raw_pwrite_stream &OS,
   CodeGenPasses.run(*M);
 }
 
+// Parse a partition serialized to bitcode into the context Ctx.
+static std::unique_ptr<Module> parsePartition(const SmallVector<char, 0> &BC,
+                                              LLVMContext &Ctx) {
+  ErrorOr<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+      MemoryBufferRef(StringRef(BC.data(), BC.size()), "<split-module>"), Ctx);
+  if (!MOrErr)
+    report_fatal_error("Failed to read bitcode");
+  return std::move(MOrErr.get());
+}
+
+// Estimate the cost of generating code for a module, as the number of IR
+// instructions in the functions it defines. A module with no instructions, e.g.
+// only global variables, still costs 1, so that such partitions are spread over
+// the outputs instead of all going to the first one.
+static uint64_t estimateCodeGenCost(const Module &M) {
+  uint64_t Cost = 0;
+  for (const Function &F : M)
+    for (const BasicBlock &BB : F)
+      Cost += BB.size();
+  return std::max<uint64_t>(Cost, 1);
+}
+
+// Split M into NumPartitions partitions, many more than the number of outputs,
+// and pack them onto the outputs: the partitions are taken from the most to the
+// least expensive, each one going to the output with the least accumulated
+// cost. Every output links its partitions together in its own context and
+// generates code for the result, so that a single huge function doesn't drag a
+// whole hash-based partition along with it and the outputs finish together.
+static void
+balancedSplitCodeGen(std::unique_ptr<Module> M,
+                     ArrayRef<llvm::raw_pwrite_stream *> OSs,
+                     unsigned NumPartitions, const Target *TheTarget,
+                     StringRef CPU, StringRef Features,
+                     const TargetOptions &Options, Reloc::Model RM,
+                     CodeModel::Model CM, CodeGenOpt::Level OL,
+                     TargetMachine::CodeGenFileType FileType,
+                     bool PreserveLocals) {
+  std::string TargetTriple = M->getTargetTriple();
+  std::string DataLayoutStr = M->getDataLayoutStr();
+
+  // Serialize the partitions to bitcode on the main thread, see the comment in
+  // splitCodeGen.
+  std::vector<SmallVector<char, 0>> PartitionsBC;
+  std::vector<uint64_t> PartitionsCost;
+  SplitModule(std::move(M), NumPartitions, [&](std::unique_ptr<Module> MPart) {
+    PartitionsCost.push_back(estimateCodeGenCost(*MPart));
+    PartitionsBC.emplace_back();
+    raw_svector_ostream BCOS(PartitionsBC.back());
+    WriteBitcodeToFile(MPart.get(), BCOS);
+  }, PreserveLocals);
+
+  // Queue the partitions by decreasing cost, ties broken by partition number
+  // to keep the output deterministic.
+  std::vector<unsigned> Order(PartitionsBC.size());
+  for (unsigned I = 0, E = Order.size(); I != E; ++I)
+    Order[I] = I;
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+    return PartitionsCost[A] > PartitionsCost[B];
+  });
+
+  // Assign each partition to the least loaded output.
+  typedef std::pair<uint64_t, unsigned> LoadTy;
+  std::priority_queue<LoadTy, std::vector<LoadTy>, std::greater<LoadTy>>
+      OutputLoads;
+  for (unsigned I = 0, E = OSs.size(); I != E; ++I)
+    OutputLoads.push(std::make_pair(0, I));
+  std::vector<std::vector<unsigned>> OutputPartitions(OSs.size());
+  for (unsigned Partition : Order) {
+    LoadTy Least = OutputLoads.top();
+    OutputLoads.pop();
+    OutputPartitions[Least.second].push_back(Partition);
+    Least.first += PartitionsCost[Partition];
+    OutputLoads.push(Least);
+  }
+
+  std::vector<thread> Threads;
+  for (unsigned I = 0, E = OSs.size(); I != E; ++I) {
+    llvm::raw_pwrite_stream *ThreadOS = OSs[I];
+    const std::vector<unsigned> &Partitions = OutputPartitions[I];
+    Threads.emplace_back([&, ThreadOS] {
+      LLVMContext Ctx;
+      // An output left without partitions still gets a valid, empty object.
+      if (Partitions.empty()) {
+        Module Empty("<split-module>", Ctx);
+        Empty.setTargetTriple(TargetTriple);
+        Empty.setDataLayout(DataLayoutStr);
+        codegen(&Empty, *ThreadOS, TheTarget, CPU, Features, Options, RM, CM,
+                OL, FileType);
+        return;
+      }
+      std::unique_ptr<Module> Combined =
+          parsePartition(PartitionsBC[Partitions[0]], Ctx);
+      Linker L(*Combined);
+      for (unsigned J = 1, JE = Partitions.size(); J != JE; ++J)
+        if (L.linkInModule(parsePartition(PartitionsBC[Partitions[J]], Ctx)))
+          report_fatal_error("Failed to link split module partitions");
+
+      codegen(Combined.get(), *ThreadOS, TheTarget, CPU, Features, Options, RM,
+              CM, OL, FileType);
+    });
+  }
+
+  for (thread &T : Threads)
+    T.join();
+}
+
 std::unique_ptr<Module>
 llvm::splitCodeGen(std::unique_ptr<Module> M,
                    ArrayRef<llvm::raw_pwrite_stream *> OSs, StringRef CPU,
@@ -58,6 +173,13 @@ llvm::splitCodeGen(std::unique_ptr<Module> M,
     return M;
   }
 
+  if (PartitionsPerOutput > 1) {
+    balancedSplitCodeGen(std::move(M), OSs, OSs.size() * PartitionsPerOutput,
+                         TheTarget, CPU, Features, Options, RM, CM, OL,
+                         FileType, PreserveLocals);
+    return {};
+  }
+
   std::vector<thread> Threads;
   SplitModule(std::move(M), OSs.size(), [&](std::unique_ptr<Module> MPart) {
     // We want to clone the module in a new context to multi-thread the codegen.
@@ -74,13 +196,7 @@ llvm::splitCodeGen(std::unique_ptr<Module> M,
         [TheTarget, CPU, Features, Options, RM, CM, OL, FileType,
          ThreadOS](const SmallVector<char, 0> &BC) {
           LLVMContext Ctx;
-          ErrorOr<std::unique_ptr<Module>> MOrErr =
-              parseBitcodeFile(MemoryBufferRef(StringRef(BC.data(), BC.size()),
-                                               "<split-module>"),
-                               Ctx);
-          if (!MOrErr)
-            report_fatal_error("Failed to read bitcode");
-          std::unique_ptr<Module> MPartInCtx = std::move(MOrErr.get());
+          std::unique_ptr<Module> MPartInCtx = parsePartition(BC, Ctx);
 
           codegen(MPartInCtx.get(), *ThreadOS, TheTarget, CPU, Features,
                   Options, RM, CM, OL, FileType);
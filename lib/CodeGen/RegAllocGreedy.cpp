@@ -36,12 +36,14 @@
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/RegisterClassInfo.h"
 #include "llvm/CodeGen/VirtRegMap.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/PassAnalysisSupport.h"
 #include "llvm/Support/BranchProbability.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
@@ -54,6 +56,7 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumBudgetReductions, "Number of times the allocation budget was cut");
 
 static cl::opt<SplitEditor::ComplementSpillMode>
 SplitSpillMode("split-spill-mode", cl::Hidden,
@@ -100,6 +103,19 @@ CSRFirstTimeCost("regalloc-csr-first-time-cost",
               cl::desc("Cost for first time use of callee-saved register."),
               cl::init(0), cl::Hidden);
 
+static cl::opt<unsigned> RegAllocBudgetIntervals(
+    "regalloc-budget-intervals", cl::Hidden,
+    cl::desc("Number of virtual registers above which the greedy allocator "
+             "gives up on its most expensive strategies (0 = unlimited)"),
+    cl::init(0));
+
+static cl::opt<unsigned> RegAllocBudgetMs(
+    "regalloc-budget-ms", cl::Hidden,
+    cl::desc("Allocation time in milliseconds after which the greedy "
+             "allocator gives up on its most expensive strategies "
+             "(0 = unlimited)"),
+    cl::init(0));
+
 static RegisterRegAlloc greedyRegAlloc("greedy", "greedy register allocator",
                                        createGreedyRegisterAllocator);
 
@@ -191,6 +207,29 @@ class RAGreedy : public MachineFunctionPass,
 
   uint8_t CutOffInfo;
 
+  /// How much effort the allocator may still spend on the current function.
+  /// The level only ever goes down while a function is allocated.
+  enum BudgetLevel {
+    /// All the strategies are available.
+    BL_Full,
+
+    /// No region splitting, no CSR first-time heuristics, no local
+    /// reassignment, and shallow last chance recoloring.
+    BL_Reduced,
+
+    /// Additionally, global live ranges are spilled instead of being split
+    /// around blocks, and broken hints are not recolored.
+    BL_Minimal
+  };
+
+  BudgetLevel Budget;
+
+  /// Maximum depth of last chance recoloring for the current budget.
+  unsigned RecoloringMaxDepth;
+
+  /// When the allocation of the current function started.
+  sys::TimeValue AllocationStart;
+
 #ifndef NDEBUG
   static const char *const StageName[];
 #endif
@@ -398,6 +437,9 @@ private:
   void tryHintRecoloring(LiveInterval &);
   void tryHintsRecoloring();
 
+  void checkBudget();
+  void reduceBudget(BudgetLevel, const Twine &Reason);
+
   /// Model the information carried by one end of a copy.
   struct HintInfo {
     /// The frequency of the copy.
@@ -1955,6 +1997,10 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
     return tryInstructionSplit(VirtReg, Order, NewVRegs);
   }
 
+  // Out of budget, global ranges are spilled rather than split.
+  if (Budget == BL_Minimal)
+    return 0;
+
   NamedRegionTimer T("Global Splitting", TimerGroupName, TimePassesIsEnabled);
 
   SA->analyze(&VirtReg);
@@ -1973,7 +2019,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   // First try to split around a region spanning multiple blocks. RS_Split2
   // ranges already made dubious progress with region splitting, so they go
   // straight to single block splitting.
-  if (getStage(VirtReg) < RS_Split2) {
+  if (getStage(VirtReg) < RS_Split2 && Budget == BL_Full) {
     unsigned PhysReg = tryRegionSplit(VirtReg, Order, NewVRegs);
     if (PhysReg || !NewVRegs.empty())
       return PhysReg;
@@ -2075,11 +2121,12 @@ unsigned RAGreedy::tryLastChanceRecoloring(LiveInterval &VirtReg,
   // Ranges must be Done.
   assert((getStage(VirtReg) >= RS_Done || !VirtReg.isSpillable()) &&
          "Last chance recoloring should really be last chance");
-  // Set the max depth to LastChanceRecoloringMaxDepth.
+  // Set the max depth to LastChanceRecoloringMaxDepth, or less when the
+  // allocation is over budget.
   // We may want to reconsider that if we end up with a too large search space
   // for target with hundreds of registers.
   // Indeed, in that case we may want to cut the search space earlier.
-  if (Depth >= LastChanceRecoloringMaxDepth && !ExhaustiveSearch) {
+  if (Depth >= RecoloringMaxDepth && !ExhaustiveSearch) {
     DEBUG(dbgs() << "Abort because max depth has been reached.\n");
     CutOffInfo |= CO_Depth;
     return ~0u;
@@ -2207,10 +2254,23 @@ bool RAGreedy::tryRecoloringCandidates(PQueue &RecoloringQueue,
 
 unsigned RAGreedy::selectOrSplit(LiveInterval &VirtReg,
                                  SmallVectorImpl<unsigned> &NewVRegs) {
+  checkBudget();
   CutOffInfo = CO_None;
   LLVMContext &Ctx = MF->getFunction()->getContext();
   SmallVirtRegSet FixedRegisters;
   unsigned Reg = selectOrSplitImpl(VirtReg, NewVRegs, FixedRegisters);
+  // The budget must not turn a successful allocation into a failure: when the
+  // shallow recoloring gave up, search again with the usual depth.
+  if (Reg == ~0U && (CutOffInfo & CO_Depth) && NewVRegs.empty() &&
+      RecoloringMaxDepth < LastChanceRecoloringMaxDepth) {
+    DEBUG(dbgs() << "Retry last chance recoloring with the full depth.\n");
+    unsigned BudgetDepth = RecoloringMaxDepth;
+    CutOffInfo = CO_None;
+    FixedRegisters.clear();
+    RecoloringMaxDepth = LastChanceRecoloringMaxDepth;
+    Reg = selectOrSplitImpl(VirtReg, NewVRegs, FixedRegisters);
+    RecoloringMaxDepth = BudgetDepth;
+  }
   if (Reg == ~0U && (CutOffInfo != CO_None)) {
     uint8_t CutOffEncountered = CutOffInfo & (CO_Depth | CO_Interf);
     if (CutOffEncountered == CO_Depth)
@@ -2465,6 +2525,41 @@ void RAGreedy::tryHintsRecoloring() {
   }
 }
 
+//===----------------------------------------------------------------------===//
+//                            Compile Time Budget
+//===----------------------------------------------------------------------===//
+
+/// Lower the budget level when the allocation of the current function has
+/// been running for longer than -regalloc-budget-ms.
+void RAGreedy::checkBudget() {
+  if (!RegAllocBudgetMs || Budget == BL_Minimal)
+    return;
+  uint64_t Elapsed = (sys::TimeValue::now() - AllocationStart).msec();
+  if (Elapsed >= 2 * (uint64_t)RegAllocBudgetMs)
+    reduceBudget(BL_Minimal, Twine(Elapsed) + " ms");
+  else if (Elapsed >= RegAllocBudgetMs && Budget == BL_Full)
+    reduceBudget(BL_Reduced, Twine(Elapsed) + " ms");
+}
+
+/// Switch to the budget level \p Level and tell the user why through an
+/// optimization remark.
+void RAGreedy::reduceBudget(BudgetLevel Level, const Twine &Reason) {
+  assert(Level > Budget && "The budget can only be reduced");
+  Budget = Level;
+  RecoloringMaxDepth = std::min<unsigned>(RecoloringMaxDepth, 1);
+  EnableLocalReassign = false;
+  ++NumBudgetReductions;
+  DEBUG(dbgs() << "Allocation budget reduced: " << Reason << '\n');
+
+  const Function &F = *MF->getFunction();
+  emitOptimizationRemarkAnalysis(
+      F.getContext(), DEBUG_TYPE, F, DebugLoc(),
+      "greedy register allocation over budget (" + Reason + "): " +
+          (Level == BL_Minimal
+               ? "spilling global live ranges instead of splitting them"
+               : "region splitting and deep recoloring disabled"));
+}
+
 unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
                                      SmallVectorImpl<unsigned> &NewVRegs,
                                      SmallVirtRegSet &FixedRegisters,
@@ -2476,8 +2571,8 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
     // When NewVRegs is not empty, we may have made decisions such as evicting
     // a virtual register, go with the earlier decisions and use the physical
     // register.
-    if (CSRCost.getFrequency() && isUnusedCalleeSavedReg(PhysReg) &&
-        NewVRegs.empty()) {
+    if (CSRCost.getFrequency() && Budget == BL_Full &&
+        isUnusedCalleeSavedReg(PhysReg) && NewVRegs.empty()) {
       unsigned CSRReg = tryAssignCSRFirstTime(VirtReg, Order, PhysReg,
                                               CostPerUseLimit, NewVRegs);
       if (CSRReg || !NewVRegs.empty())
@@ -2599,8 +2694,18 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   GlobalCand.resize(32);  // This will grow as needed.
   SetOfBrokenHints.clear();
 
+  Budget = BL_Full;
+  RecoloringMaxDepth = LastChanceRecoloringMaxDepth;
+  AllocationStart = sys::TimeValue::now();
+  unsigned NumVirtRegs = MRI->getNumVirtRegs();
+  if (RegAllocBudgetIntervals && NumVirtRegs > RegAllocBudgetIntervals)
+    reduceBudget(NumVirtRegs > 4 * RegAllocBudgetIntervals ? BL_Minimal
+                                                           : BL_Reduced,
+                 Twine(NumVirtRegs) + " virtual registers");
+
   allocatePhysRegs();
-  tryHintsRecoloring();
+  if (Budget != BL_Minimal)
+    tryHintsRecoloring();
   releaseMemory();
   return true;
 }
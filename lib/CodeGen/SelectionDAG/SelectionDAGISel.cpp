@@ -72,12 +72,8 @@ STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
 STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
 STATISTIC(NumFastIselFailLowerArguments,
           "Number of entry blocks where fast isel failed to lower arguments");
-
-#ifndef NDEBUG
-static cl::opt<bool>
-EnableFastISelVerbose2("fast-isel-verbose2", cl::Hidden,
-          cl::desc("Enable extra verbose messages in the \"fast\" "
-                   "instruction selector"));
+STATISTIC(NumFastIselInstFallbacks,
+          "Number of instructions fast isel let DAG isel select on their own");
 
   // Terminators
 STATISTIC(NumFastIselFailRet,"Fast isel fails on Ret");
@@ -165,7 +161,7 @@ STATISTIC(NumFastIselFailFrameaddress, "Fast isel fails on Frameaddress");
 STATISTIC(NumFastIselFailSqrt, "Fast isel fails on sqrt call");
 STATISTIC(NumFastIselFailStackMap, "Fast isel fails on StackMap call");
 STATISTIC(NumFastIselFailPatchPoint, "Fast isel fails on PatchPoint call");
-#endif
+STATISTIC(NumFastIselFailOther, "Fast isel fails on other instructions");
 
 static cl::opt<bool>
 EnableFastISelVerbose("fast-isel-verbose", cl::Hidden,
@@ -178,6 +174,11 @@ static cl::opt<int> EnableFastISelAbort(
              "abort but for args, calls and terminators, 2 will also "
              "abort for argument lowering, and 3 will never fallback "
              "to SelectionDAG."));
+static cl::opt<bool> EnableFastISelInstFallback(
+    "fast-isel-inst-fallback", cl::Hidden,
+    cl::desc("When \"fast\" instruction selection fails on an instruction "
+             "other than a terminator, select only this instruction with "
+             "SelectionDAG and resume fast instruction selection"));
 
 static cl::opt<bool>
 UseMBPI("use-mbpi",
@@ -1041,14 +1042,34 @@ static bool isFoldedOrDeadInstruction(const Instruction *I,
          !FuncInfo->isExportedInst(I); // Exported instrs must be computed.
 }
 
-#ifndef NDEBUG
+/// hasSingleRegisterTypes - Return true if the value defined by \p I and all
+/// of its operands fit in one legal register each. FastISel and SelectionDAG
+/// only agree on the virtual registers holding such values, so only such
+/// instructions can be handed to SelectionDAG on their own.
+static bool hasSingleRegisterTypes(const Instruction *I,
+                                   const TargetLowering &TLI,
+                                   const DataLayout &DL) {
+  auto IsSingleRegister = [&](Type *Ty) {
+    if (Ty->isVoidTy() || Ty->isTokenTy())
+      return true;
+    EVT VT = TLI.getValueType(DL, Ty, /*AllowUnknown=*/true);
+    return VT.isSimple() && TLI.isTypeLegal(VT);
+  };
+  if (!IsSingleRegister(I->getType()))
+    return false;
+  for (const Use &Op : I->operands())
+    if (!IsSingleRegister(Op->getType()))
+      return false;
+  return true;
+}
+
 // Collect per Instruction statistics for fast-isel misses.  Only those
 // instructions that cause the bail are accounted for.  It does not account for
 // instructions higher in the block.  Thus, summing the per instructions stats
 // will not add up to what is reported by NumFastIselFailures.
 static void collectFailStats(const Instruction *I) {
   switch (I->getOpcode()) {
-  default: assert (0 && "<Invalid operator> ");
+  default: NumFastIselFailOther++; return;
 
   // Terminators
   case Instruction::Ret:         NumFastIselFailRet++; return;
@@ -1149,7 +1170,6 @@ static void collectFailStats(const Instruction *I) {
   case Instruction::LandingPad:     NumFastIselFailLandingPad++; return;
   }
 }
-#endif // NDEBUG
 
 void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
   // Initialize the Fast-ISel state, if needed.
@@ -1274,19 +1294,24 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
           continue;
         }
 
-#ifndef NDEBUG
-        if (EnableFastISelVerbose2)
-          collectFailStats(Inst);
-#endif
+        collectFailStats(Inst);
 
-        // Then handle certain instructions as single-LLVM-Instruction blocks.
-        if (isa<CallInst>(Inst)) {
+        // Then handle certain instructions as single-LLVM-Instruction blocks:
+        // calls, and with -fast-isel-inst-fallback anything but terminators
+        // and EH pads, whose lowering involves the rest of the block, and
+        // values that SelectionDAG splits across several registers.
+        bool IsCall = isa<CallInst>(Inst);
+        if (IsCall ||
+            (EnableFastISelInstFallback && !isa<TerminatorInst>(Inst) &&
+             !Inst->isEHPad() &&
+             hasSingleRegisterTypes(Inst, *TLI, CurDAG->getDataLayout()))) {
+          ++NumFastIselInstFallbacks;
 
           if (EnableFastISelVerbose || EnableFastISelAbort) {
-            dbgs() << "FastISel missed call: ";
+            dbgs() << (IsCall ? "FastISel missed call: " : "FastISel miss: ");
             Inst->dump();
           }
-          if (EnableFastISelAbort > 2)
+          if (EnableFastISelAbort > 2 || (!IsCall && EnableFastISelAbort))
             // FastISel selector couldn't handle something and bailed.
             // For the purpose of debugging, just abort.
             report_fatal_error("FastISel didn't select the entire block");
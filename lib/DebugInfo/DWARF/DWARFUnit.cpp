@@ -12,7 +12,9 @@
 #include "llvm/DebugInfo/DWARF/DWARFFormValue.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
 #include <cstdio>
+#include <queue>
 
 namespace llvm {
 using namespace dwarf;
@@ -136,6 +138,8 @@ void DWARFUnit::clear() {
   RangeSectionBase = 0;
   AddrOffsetSectionBase = 0;
   clearDIEs(false);
+  SubprogramIndex.clear();
+  SubprogramIndexBuilt = false;
   DWO.reset();
 }
 
@@ -155,13 +159,14 @@ uint64_t DWARFUnit::getDWOId() {
       .getAttributeValueAsUnsignedConstant(this, DW_AT_GNU_dwo_id, FailValue);
 }
 
-void DWARFUnit::setDIERelations() {
-  if (DieArray.size() <= 1)
+void DWARFUnit::setDIERelations(
+    std::vector<DWARFDebugInfoEntryMinimal> &DIEs) {
+  if (DIEs.size() <= 1)
     return;
 
   std::vector<DWARFDebugInfoEntryMinimal *> ParentChain;
   DWARFDebugInfoEntryMinimal *SiblingChain = nullptr;
-  for (auto &DIE : DieArray) {
+  for (auto &DIE : DIEs) {
     if (SiblingChain) {
       SiblingChain->setSibling(&DIE);
     }
@@ -180,7 +185,7 @@ void DWARFUnit::setDIERelations() {
       ParentChain.pop_back();
     }
   }
-  assert(SiblingChain == nullptr || SiblingChain == &DieArray[0]);
+  assert(SiblingChain == nullptr || SiblingChain == &DIEs[0]);
   assert(ParentChain.empty());
 }
 
@@ -261,10 +266,29 @@ size_t DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
     // skeleton CU DIE, so that DWARF users not aware of it are not broken.
   }
 
-  setDIERelations();
+  setDIERelations(DieArray);
   return DieArray.size();
 }
 
+void DWARFUnit::extractSubtreeToVector(
+    uint32_t DIEOffset, std::vector<DWARFDebugInfoEntryMinimal> &DIEs) const {
+  uint32_t NextCUOffset = getNextUnitOffset();
+  DWARFDebugInfoEntryMinimal DIE;
+  uint32_t Depth = 0;
+  size_t Begin = DIEs.size();
+  while (DIEOffset < NextCUOffset && DIE.extractFast(this, &DIEOffset)) {
+    DIEs.push_back(DIE);
+    if (DIE.hasChildren())
+      ++Depth;
+    else if (DIE.isNULL() && Depth > 0)
+      --Depth;
+    if (Depth == 0)
+      return;
+  }
+  // The subtree is not terminated.
+  DIEs.resize(Begin);
+}
+
 DWARFUnit::DWOHolder::DWOHolder(StringRef DWOPath)
     : DWOFile(), DWOContext(), DWOU(nullptr) {
   auto Obj = object::ObjectFile::createObjectFile(DWOPath);
@@ -323,6 +347,7 @@ void DWARFUnit::clearDIEs(bool KeepCUDie) {
     if (KeepCUDie)
       DieArray.push_back(TmpArray.front());
   }
+  SubprogramDIEs.clear();
 }
 
 void DWARFUnit::collectAddressRanges(DWARFAddressRangesVector &CURanges) {
@@ -339,11 +364,12 @@ void DWARFUnit::collectAddressRanges(DWARFAddressRangesVector &CURanges) {
   // This function is usually called if there in no .debug_aranges section
   // in order to produce a compile unit level set of address ranges that
   // is accurate. If the DIEs weren't parsed, then we don't want all dies for
-  // all compile units to stay loaded when they weren't needed. So we can end
-  // up parsing the DWARF and then throwing them all away to keep memory usage
-  // down.
-  const bool ClearDIEs = extractDIEsIfNeeded(false) > 1;
-  DieArray[0].collectChildrenAddressRanges(this, CURanges);
+  // all compile units to be loaded when they aren't needed, so we only
+  // decode them one at a time.
+  forEachSubprogramDIE([&](const DWARFDebugInfoEntryMinimal &DIE) {
+    const auto &DIERanges = DIE.getAddressRanges(this);
+    CURanges.insert(CURanges.end(), DIERanges.begin(), DIERanges.end());
+  });
 
   // Collect address ranges from DIEs in .dwo if necessary.
   bool DWOCreated = parseDWO();
@@ -351,23 +377,123 @@ void DWARFUnit::collectAddressRanges(DWARFAddressRangesVector &CURanges) {
     DWO->getUnit()->collectAddressRanges(CURanges);
   if (DWOCreated)
     DWO.reset();
+}
+
+void DWARFUnit::forEachSubprogramDIE(
+    function_ref<void(const DWARFDebugInfoEntryMinimal &)> Fn) {
+  // The base address used by the range lists comes from the unit DIE.
+  extractDIEsIfNeeded(true);
+  if (DieArray.empty())
+    return;
+  if (DieArray.size() > 1) {
+    for (const DWARFDebugInfoEntryMinimal &DIE : DieArray)
+      if (DIE.isSubprogramDIE())
+        Fn(DIE);
+    return;
+  }
 
-  // Keep memory down by clearing DIEs if this generate function
-  // caused them to be parsed.
-  if (ClearDIEs)
-    clearDIEs(true);
+  uint32_t DIEOffset = Offset + getHeaderSize();
+  uint32_t NextCUOffset = getNextUnitOffset();
+  DWARFDebugInfoEntryMinimal DIE;
+  uint32_t Depth = 0;
+  while (DIEOffset < NextCUOffset && DIE.extractFast(this, &DIEOffset)) {
+    if (DIE.isNULL()) {
+      if (Depth > 0)
+        --Depth;
+      if (Depth == 0)
+        break;
+      continue;
+    }
+    if (DIE.isSubprogramDIE())
+      Fn(DIE);
+    // Don't skip the members of types: GCC emits the definitions of the
+    // methods of local classes and lambdas inside the class DIE.
+    if (DIE.hasChildren())
+      ++Depth;
+  }
+}
+
+void DWARFUnit::buildSubprogramIndex() {
+  struct Candidate {
+    uint64_t LowPC;
+    uint64_t HighPC;
+    uint32_t DIEOffset;
+  };
+  // DIEs come in offset order, so a smaller offset means an earlier DIE.
+  std::vector<Candidate> Candidates;
+  std::vector<uint64_t> Boundaries;
+  forEachSubprogramDIE([&](const DWARFDebugInfoEntryMinimal &DIE) {
+    for (const auto &R : DIE.getAddressRanges(this)) {
+      if (R.first >= R.second)
+        continue;
+      Candidates.push_back({R.first, R.second, DIE.getOffset()});
+      Boundaries.push_back(R.first);
+      Boundaries.push_back(R.second);
+    }
+  });
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   [](const Candidate &LHS, const Candidate &RHS) {
+                     return LHS.LowPC < RHS.LowPC;
+                   });
+  std::sort(Boundaries.begin(), Boundaries.end());
+  Boundaries.erase(std::unique(Boundaries.begin(), Boundaries.end()),
+                   Boundaries.end());
+
+  // Ranges may overlap, e.g. for functions discarded by the linker. A linear
+  // search would return the first DIE containing the address, so split the
+  // ranges at every boundary and give each piece to the earliest DIE that
+  // covers it.
+  auto IsLater = [&](unsigned LHS, unsigned RHS) {
+    return Candidates[LHS].DIEOffset > Candidates[RHS].DIEOffset;
+  };
+  std::priority_queue<unsigned, std::vector<unsigned>, decltype(IsLater)>
+      Active(IsLater);
+  unsigned Next = 0;
+  for (unsigned I = 0, E = Boundaries.size(); I + 1 < E; ++I) {
+    uint64_t Start = Boundaries[I];
+    while (Next < Candidates.size() && Candidates[Next].LowPC <= Start)
+      Active.push(Next++);
+    while (!Active.empty() && Candidates[Active.top()].HighPC <= Start)
+      Active.pop();
+    if (Active.empty())
+      continue;
+    uint32_t DIEOffset = Candidates[Active.top()].DIEOffset;
+    if (!SubprogramIndex.empty() && SubprogramIndex.back().HighPC == Start &&
+        SubprogramIndex.back().DIEOffset == DIEOffset)
+      SubprogramIndex.back().HighPC = Boundaries[I + 1];
+    else
+      SubprogramIndex.push_back({Start, Boundaries[I + 1], DIEOffset});
+  }
+  SubprogramIndexBuilt = true;
 }
 
 const DWARFDebugInfoEntryMinimal *
 DWARFUnit::getSubprogramForAddress(uint64_t Address) {
-  extractDIEsIfNeeded(false);
-  for (const DWARFDebugInfoEntryMinimal &DIE : DieArray) {
-    if (DIE.isSubprogramDIE() &&
-        DIE.addressRangeContainsAddress(this, Address)) {
-      return &DIE;
-    }
+  if (!SubprogramIndexBuilt)
+    buildSubprogramIndex();
+  auto It = std::upper_bound(
+      SubprogramIndex.begin(), SubprogramIndex.end(), Address,
+      [](uint64_t Address, const SubprogramRange &R) {
+        return Address < R.LowPC;
+      });
+  if (It == SubprogramIndex.begin() || Address >= (--It)->HighPC)
+    return nullptr;
+  return getSubprogramDIE(It->DIEOffset);
+}
+
+const DWARFDebugInfoEntryMinimal *
+DWARFUnit::getSubprogramDIE(uint32_t DIEOffset) {
+  if (DieArray.size() > 1) {
+    const DWARFDebugInfoEntryMinimal *DIE = getDIEForOffset(DIEOffset);
+    assert(DIE && DIE->getOffset() == DIEOffset);
+    return DIE;
+  }
+  std::vector<DWARFDebugInfoEntryMinimal> &DIEs = SubprogramDIEs[DIEOffset];
+  if (DIEs.empty()) {
+    extractSubtreeToVector(DIEOffset, DIEs);
+    setDIERelations(DIEs);
   }
-  return nullptr;
+  return DIEs.empty() ? nullptr : &DIEs[0];
 }
 
 DWARFDebugInfoEntryInlinedChain
@@ -49,10 +49,12 @@ namespace symbolize {
 
 ErrorOr<DILineInfo> LLVMSymbolizer::symbolizeCode(const std::string &ModuleName,
                                                   uint64_t ModuleOffset) {
-  auto InfoOrErr = getOrCreateModuleInfo(ModuleName);
-  if (auto EC = InfoOrErr.getError())
+  auto EntryOrErr = getOrCreateModuleInfo(ModuleName);
+  if (auto EC = EntryOrErr.getError())
     return EC;
-  SymbolizableModule *Info = InfoOrErr.get();
+  std::shared_ptr<ModuleEntry> Entry = EntryOrErr.get();
+  sys::ScopedLock Guard(Entry->Lock);
+  SymbolizableModule *Info = Entry->Info.get();
 
   // If the user is giving us relative addresses, add the preferred base of the
   // object to the offset before we do the query. It's what DIContext expects.
@@ -69,10 +71,12 @@ ErrorOr<DILineInfo> LLVMSymbolizer::symbolizeCode(const std::string &ModuleName,
 ErrorOr<DIInliningInfo>
 LLVMSymbolizer::symbolizeInlinedCode(const std::string &ModuleName,
                                      uint64_t ModuleOffset) {
-  auto InfoOrErr = getOrCreateModuleInfo(ModuleName);
-  if (auto EC = InfoOrErr.getError())
+  auto EntryOrErr = getOrCreateModuleInfo(ModuleName);
+  if (auto EC = EntryOrErr.getError())
     return EC;
-  SymbolizableModule *Info = InfoOrErr.get();
+  std::shared_ptr<ModuleEntry> Entry = EntryOrErr.get();
+  sys::ScopedLock Guard(Entry->Lock);
+  SymbolizableModule *Info = Entry->Info.get();
 
   // If the user is giving us relative addresses, add the preferred base of the
   // object to the offset before we do the query. It's what DIContext expects.
@@ -92,10 +96,12 @@ LLVMSymbolizer::symbolizeInlinedCode(const std::string &ModuleName,
 
 ErrorOr<DIGlobal> LLVMSymbolizer::symbolizeData(const std::string &ModuleName,
                                                 uint64_t ModuleOffset) {
-  auto InfoOrErr = getOrCreateModuleInfo(ModuleName);
-  if (auto EC = InfoOrErr.getError())
+  auto EntryOrErr = getOrCreateModuleInfo(ModuleName);
+  if (auto EC = EntryOrErr.getError())
     return EC;
-  SymbolizableModule *Info = InfoOrErr.get();
+  std::shared_ptr<ModuleEntry> Entry = EntryOrErr.get();
+  sys::ScopedLock Guard(Entry->Lock);
+  SymbolizableModule *Info = Entry->Info.get();
 
   // If the user is giving us relative addresses, add the preferred base of
   // the object to the offset before we do the query. It's what DIContext
@@ -110,6 +116,8 @@ ErrorOr<DIGlobal> LLVMSymbolizer::symbolizeData(const std::string &ModuleName,
 }
 
 void LLVMSymbolizer::flush() {
+  sys::ScopedLock Guard(CacheLock);
+  ModuleLRU.clear();
   ObjectForUBPathAndArch.clear();
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
@@ -331,14 +339,27 @@ LLVMSymbolizer::getOrCreateObject(const std::string &Path,
   return object_error::arch_not_found;
 }
 
-ErrorOr<SymbolizableModule *>
+void LLVMSymbolizer::evictModules() {
+  if (!Opts.MaxOpenModules)
+    return;
+  while (ModuleLRU.size() > Opts.MaxOpenModules) {
+    // Queries still running on the module keep it alive until they finish.
+    Modules.erase(ModuleLRU.back());
+    ModuleLRU.pop_back();
+  }
+}
+
+ErrorOr<std::shared_ptr<LLVMSymbolizer::ModuleEntry>>
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
+  sys::ScopedLock Guard(CacheLock);
   const auto &I = Modules.find(ModuleName);
   if (I != Modules.end()) {
-    auto &InfoOrErr = I->second;
-    if (auto EC = InfoOrErr.getError())
+    auto &EntryOrErr = I->second;
+    if (auto EC = EntryOrErr.getError())
       return EC;
-    return InfoOrErr->get();
+    std::shared_ptr<ModuleEntry> &Entry = EntryOrErr.get();
+    ModuleLRU.splice(ModuleLRU.begin(), ModuleLRU, Entry->LRUPos);
+    return Entry;
   }
   std::string BinaryName = ModuleName;
   std::string ArchName = Opts.DefaultArch;
@@ -375,12 +396,18 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   assert(Context);
   auto InfoOrErr =
       SymbolizableObjectFile::create(Objects.first, std::move(Context));
-  auto InsertResult =
-      Modules.insert(std::make_pair(ModuleName, std::move(InfoOrErr)));
-  assert(InsertResult.second);
-  if (auto EC = InsertResult.first->second.getError())
+  if (auto EC = InfoOrErr.getError()) {
+    Modules.insert(std::make_pair(ModuleName, EC));
     return EC;
-  return InsertResult.first->second->get();
+  }
+  auto Entry = std::make_shared<ModuleEntry>();
+  Entry->Info = std::move(InfoOrErr.get());
+  Entry->LRUPos = ModuleLRU.insert(ModuleLRU.begin(), ModuleName);
+  auto InsertResult = Modules.insert(std::make_pair(ModuleName, Entry));
+  assert(InsertResult.second);
+  (void)InsertResult;
+  evictModules();
+  return Entry;
 }
 
 // Undo these various manglings for Win32 extern "C" functions:
@@ -0,0 +1,132 @@
+//===-- PersistentObjectCache.cpp - On-disk cache keyed by IR hash --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace orc {
+
+// Return true if the module has an absolute address in the initializer of a
+// global or in an aliasee, like the stub addresses of the globals module built
+// by the CompileOnDemandLayer. The object would only be valid in the process
+// that built it, and its key would never be looked up again.
+static bool hasAbsoluteAddresses(const Module &M) {
+  SmallVector<const Constant *, 16> Worklist;
+  for (const GlobalVariable &GV : M.globals())
+    if (GV.hasInitializer())
+      Worklist.push_back(GV.getInitializer());
+  for (const GlobalAlias &GA : M.aliases())
+    Worklist.push_back(GA.getAliasee());
+
+  SmallPtrSet<const Constant *, 16> Visited;
+  while (!Worklist.empty()) {
+    const Constant *C = Worklist.pop_back_val();
+    if (isa<GlobalValue>(C) || !Visited.insert(C).second)
+      continue;
+    if (auto *CE = dyn_cast<ConstantExpr>(C))
+      if (CE->getOpcode() == Instruction::IntToPtr &&
+          isa<ConstantInt>(CE->getOperand(0)))
+        return true;
+    for (const Use &Op : C->operands())
+      Worklist.push_back(cast<Constant>(Op));
+  }
+  return false;
+}
+
+PersistentObjectCache::PersistentObjectCache(std::string CacheDir,
+                                             std::string Signature)
+    : CacheDir(std::move(CacheDir)), Signature(std::move(Signature)) {}
+
+std::string PersistentObjectCache::getCachePath(const Module &M) const {
+  std::string IR;
+  {
+    raw_string_ostream IRStream(IR);
+    M.print(IRStream, nullptr);
+  }
+
+  MD5 Hash;
+  Hash.update(Signature);
+  // Keep the signature and the IR from running into each other.
+  uint8_t Separator = 0;
+  Hash.update(makeArrayRef(Separator));
+  Hash.update(IR);
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  MD5::stringifyResult(Result, Key);
+
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, Key + ".o");
+  return Path.str();
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  if (hasAbsoluteAddresses(*M))
+    return nullptr;
+  std::string Path = getCachePath(*M);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+      MemoryBuffer::getFile(Path, -1, false);
+  if (!Buffer) {
+    // The object will be compiled: remember where it goes.
+    sys::ScopedLock Guard(PendingLock);
+    PendingPaths[M] = std::move(Path);
+    return nullptr;
+  }
+  // The JIT may write into the buffer, so don't hand it the mapped file.
+  return MemoryBuffer::getMemBufferCopy((*Buffer)->getBuffer(),
+                                        (*Buffer)->getBufferIdentifier());
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string Path;
+  {
+    sys::ScopedLock Guard(PendingLock);
+    auto I = PendingPaths.find(M);
+    if (I == PendingPaths.end())
+      return;
+    Path = std::move(I->second);
+    PendingPaths.erase(I);
+  }
+
+  if (sys::fs::create_directories(CacheDir))
+    return;
+
+  // Write to a temporary file first so that no reader, in this process or
+  // another, ever sees a partial object.
+  int FD;
+  SmallString<128> TempPath;
+  if (sys::fs::createUniqueFile(Path + ".%%%%%%.tmp", FD, TempPath))
+    return;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write(Obj.getBufferStart(), Obj.getBufferSize());
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (sys::fs::rename(TempPath, Path))
+    sys::fs::remove(TempPath);
+}
+
+} // End namespace orc.
+} // End namespace llvm.
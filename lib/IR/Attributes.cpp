@@ -39,6 +39,7 @@ Attribute Attribute::get(LLVMContext &Context, Attribute::AttrKind Kind,
   ID.AddInteger(Kind);
   if (Val) ID.AddInteger(Val);
 
+  UniquingLock Lock(pImpl->AttributesLock);
   void *InsertPoint;
   AttributeImpl *PA = pImpl->AttrsSet.FindNodeOrInsertPos(ID, InsertPoint);
 
@@ -62,6 +63,7 @@ Attribute Attribute::get(LLVMContext &Context, StringRef Kind, StringRef Val) {
   ID.AddString(Kind);
   if (!Val.empty()) ID.AddString(Val);
 
+  UniquingLock Lock(pImpl->AttributesLock);
   void *InsertPoint;
   AttributeImpl *PA = pImpl->AttrsSet.FindNodeOrInsertPos(ID, InsertPoint);
 
@@ -481,6 +483,7 @@ AttributeSetNode *AttributeSetNode::get(LLVMContext &C,
   for (Attribute Attr : SortedAttrs)
     Attr.Profile(ID);
 
+  UniquingLock Lock(pImpl->AttributesLock);
   void *InsertPoint;
   AttributeSetNode *PA =
     pImpl->AttrsSetNodes.FindNodeOrInsertPos(ID, InsertPoint);
@@ -609,6 +612,7 @@ AttributeSet::getImpl(LLVMContext &C,
   FoldingSetNodeID ID;
   AttributeSetImpl::Profile(ID, Attrs);
 
+  UniquingLock Lock(pImpl->AttributesLock);
   void *InsertPoint;
   AttributeSetImpl *PA = pImpl->AttrsLists.FindNodeOrInsertPos(ID, InsertPoint);
 
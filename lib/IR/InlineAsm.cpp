@@ -30,6 +30,7 @@ InlineAsm *InlineAsm::get(FunctionType *FTy, StringRef AsmString,
   InlineAsmKeyType Key(AsmString, Constraints, FTy, hasSideEffects,
                        isAlignStack, asmDialect);
   LLVMContextImpl *pImpl = FTy->getContext().pImpl;
+  UniquingLock Lock(pImpl->ConstantsLock);
   return pImpl->InlineAsms.getOrCreate(PointerType::getUnqual(FTy), Key);
 }
 
@@ -47,7 +48,9 @@ InlineAsm::InlineAsm(FunctionType *FTy, const std::string &asmString,
 }
 
 void InlineAsm::destroyConstant() {
-  getType()->getContext().pImpl->InlineAsms.remove(this);
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  UniquingLock Lock(pImpl->ConstantsLock);
+  pImpl->InlineAsms.remove(this);
   delete this;
 }
 
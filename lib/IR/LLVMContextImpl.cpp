@@ -20,7 +20,13 @@
 using namespace llvm;
 
 LLVMContextImpl::LLVMContextImpl(LLVMContext &C)
-  : TheTrueVal(nullptr), TheFalseVal(nullptr),
+  : ThreadSafeUniquing(false),
+    ConstantsLock(ThreadSafeUniquing),
+    TypesLock(ThreadSafeUniquing),
+    AttributesLock(ThreadSafeUniquing),
+    MetadataLock(ThreadSafeUniquing),
+    ValueNamesLock(ThreadSafeUniquing),
+    TheTrueVal(nullptr), TheFalseVal(nullptr),
     VoidTy(C, Type::VoidTyID),
     LabelTy(C, Type::LabelTyID),
     HalfTy(C, Type::HalfTyID),
@@ -32,6 +32,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/Mutex.h"
 #include <vector>
 
 namespace llvm {
@@ -899,6 +900,44 @@ public:
   }
 };
 
+/// \brief A lock guarding some of the uniquing tables of a context.
+///
+/// It is only taken when the context is shared between threads, see
+/// LLVMContext::setThreadSafeUniquing. It is recursive as creating a constant
+/// can create the constants it refers to.
+class UniquingMutex {
+  const bool &Enabled;
+  sys::SmartMutex<true> M;
+
+  friend class UniquingLock;
+
+public:
+  explicit UniquingMutex(const bool &Enabled) : Enabled(Enabled) {}
+};
+
+/// \brief Scoped lock of a \c UniquingMutex.
+///
+/// The uniquing locks of a context are always taken in this order: constants,
+/// types and metadata. The attribute and value name locks are independent
+/// from the others.
+class UniquingLock {
+  sys::SmartMutex<true> *M;
+
+public:
+  explicit UniquingLock(UniquingMutex &UM)
+      : M(UM.Enabled ? &UM.M : nullptr) {
+    if (M)
+      M->lock();
+  }
+  ~UniquingLock() {
+    if (M)
+      M->unlock();
+  }
+
+  UniquingLock(const UniquingLock &) = delete;
+  void operator=(const UniquingLock &) = delete;
+};
+
 class LLVMContextImpl {
 public:
   /// OwnedModules - The set of modules instantiated in this context, and which
@@ -915,6 +954,22 @@ public:
   LLVMContext::YieldCallbackTy YieldCallback;
   void *YieldOpaqueHandle;
 
+  /// Whether the uniquing tables are shared between threads, in which case the
+  /// locks below guard them.
+  bool ThreadSafeUniquing;
+
+  /// Guards the constant tables, including the inline asms.
+  UniquingMutex ConstantsLock;
+  /// Guards the type tables and TypeAllocator.
+  UniquingMutex TypesLock;
+  /// Guards the attribute folding sets.
+  UniquingMutex AttributesLock;
+  /// Guards MDStringCache, the uniqued and distinct metadata nodes, the
+  /// metadata wrappers of values and the metadata kind names.
+  UniquingMutex MetadataLock;
+  /// Guards ValueNames, which every named value of the context goes through.
+  UniquingMutex ValueNamesLock;
+
   typedef DenseMap<APInt, ConstantInt *, DenseMapAPIntKeyInfo> IntMapTy;
   IntMapTy IntConstants;
 
@@ -19,14 +19,19 @@
 #include "llvm/IR/LegacyPassNameParser.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <unordered_set>
 using namespace llvm;
@@ -499,9 +504,63 @@ public:
   }
 };
 
+//===----------------------------------------------------------------------===//
+/// PassTraceInfo Class - This class records every pass execution, with the
+/// IR unit it ran on, its duration, the change in the instruction count of
+/// the IR unit and the memory usage, and writes them as a Chrome trace-event
+/// JSON file on exit. This only happens when -pass-trace is enabled on the
+/// command line.
+///
+class PassTraceInfo {
+  struct TraceEvent {
+    std::string PassName;
+    std::string IRName;
+    const char *Category;
+    unsigned ThreadID;
+    uint64_t Start;    // In microseconds since the creation of the trace.
+    uint64_t Duration; // In microseconds.
+    unsigned InstCountBefore;
+    unsigned InstCountAfter;
+    size_t MallocUsage;
+    size_t PeakMallocUsage;
+  };
+
+  sys::SmartMutex<true> Lock;
+  std::vector<TraceEvent> Events;
+  sys::TimeValue Origin;
+  size_t PeakMallocUsage;
+  std::atomic<unsigned> NextThreadID;
+
+public:
+  // Use 'create' member to get this.
+  PassTraceInfo()
+      : Origin(sys::TimeValue::now()), PeakMallocUsage(0), NextThreadID(0) {}
+
+  // Write out the trace.
+  ~PassTraceInfo();
+
+  // createTheTraceInfo - This method either initializes the TheTraceInfo
+  // pointer to a non-null value (if the -pass-trace option is enabled) or it
+  // leaves it null. It may be called multiple times.
+  static void createTheTraceInfo();
+
+  /// Return the number of microseconds elapsed since the trace started.
+  uint64_t now() const {
+    sys::TimeValue Elapsed = sys::TimeValue::now() - Origin;
+    return uint64_t(Elapsed.seconds()) * 1000000 + Elapsed.microseconds();
+  }
+
+  /// Record the execution of pass \p P on the IR unit \p IRName.
+  void addEvent(Pass *P, StringRef IRName, const char *Category,
+                uint64_t Start, unsigned InstCountBefore,
+                unsigned InstCountAfter);
+};
+
 } // End of anon namespace
 
 static TimingInfo *TheTimeInfo;
+static PassTraceInfo *TheTraceInfo;
+
 
 //===----------------------------------------------------------------------===//
 // PMTopLevelManager implementation
@@ -1330,6 +1389,7 @@ bool BBPassManager::runOnFunction(Function &F) {
         // If the pass crashes, remember this.
         PassManagerPrettyStackEntry X(BP, *I);
         TimeRegion PassTimer(getPassTimer(BP));
+        PassTraceRegion PassTrace(BP, *I);
 
         LocalChanged |= BP->runOnBasicBlock(*I);
       }
@@ -1493,6 +1553,7 @@ void FunctionPassManagerImpl::releaseMemoryOnTheFly() {
 bool FunctionPassManagerImpl::run(Function &F) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  PassTraceInfo::createTheTraceInfo();
 
   initializeAllAnalysisInfo();
   for (unsigned Index = 0; Index < getNumContainedManagers(); ++Index) {
@@ -1546,6 +1607,7 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      PassTraceRegion PassTrace(FP, F);
 
       LocalChanged |= FP->runOnFunction(F);
     }
@@ -1623,6 +1685,7 @@ MPPassManager::runOnModule(Module &M) {
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      PassTraceRegion PassTrace(MP, M);
 
       LocalChanged |= MP->runOnModule(M);
     }
@@ -1718,6 +1781,7 @@ Pass* MPPassManager::getOnTheFlyPass(Pass *MP, AnalysisID PI, Function &F){
 bool PassManagerImpl::run(Module &M) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  PassTraceInfo::createTheTraceInfo();
 
   dumpArguments();
   dumpPasses();
@@ -1789,6 +1853,141 @@ Timer *llvm::getPassTimer(Pass *P) {
   return nullptr;
 }
 
+//===----------------------------------------------------------------------===//
+// PassTraceInfo implementation
+
+static cl::opt<std::string> PassTraceFilename(
+    "pass-trace", cl::value_desc("filename"),
+    cl::desc("Record each pass execution with its duration, the instruction "
+             "count change and memory usage of the IR unit it ran on, and "
+             "write them on exit as a Chrome trace-event JSON file"));
+
+// createTheTraceInfo - This method either initializes the TheTraceInfo
+// pointer to a non-null value (if the -pass-trace option is enabled) or it
+// leaves it null. It may be called multiple times.
+void PassTraceInfo::createTheTraceInfo() {
+  if (PassTraceFilename.empty() || TheTraceInfo)
+    return;
+
+  // Constructed the first time this is called, iff -pass-trace is enabled,
+  // and destroyed (writing the trace) by llvm_shutdown().
+  static ManagedStatic<PassTraceInfo> PTI;
+  TheTraceInfo = &*PTI;
+}
+
+/// Identify the threads running passes with small integers, as expected by
+/// the trace viewers. 0 means that the thread hasn't been numbered yet.
+static LLVM_THREAD_LOCAL unsigned TraceThreadID = 0;
+
+void PassTraceInfo::addEvent(Pass *P, StringRef IRName, const char *Category,
+                             uint64_t Start, unsigned InstCountBefore,
+                             unsigned InstCountAfter) {
+  uint64_t End = now();
+  // The malloc usage is sampled at the end of every pass, the peak is the
+  // high-water mark of these samples.
+  size_t MallocUsage = sys::Process::GetMallocUsage();
+
+  if (!TraceThreadID)
+    TraceThreadID = ++NextThreadID;
+
+  sys::SmartScopedLock<true> Guard(Lock);
+  PeakMallocUsage = std::max(PeakMallocUsage, MallocUsage);
+  Events.push_back({P->getPassName(), IRName, Category, TraceThreadID, Start,
+                    End - Start, InstCountBefore, InstCountAfter, MallocUsage,
+                    PeakMallocUsage});
+}
+
+static unsigned getInstructionCount(const Function &F) {
+  unsigned Count = 0;
+  for (const BasicBlock &BB : F)
+    Count += BB.size();
+  return Count;
+}
+
+PassTraceRegion::PassTraceRegion(Pass *P, StringRef IRName,
+                                 const char *Category,
+                                 std::function<unsigned()> CountInstructions)
+    : P(nullptr) {
+  // Pass managers are not recorded, only the passes they run.
+  if (!TheTraceInfo || P->getAsPMDataManager())
+    return;
+  this->P = P;
+  this->IRName = IRName;
+  this->Category = Category;
+  this->CountInstructions = std::move(CountInstructions);
+  InstCountBefore = this->CountInstructions();
+  Start = TheTraceInfo->now();
+}
+
+PassTraceRegion::PassTraceRegion(Pass *P, Module &M)
+    : PassTraceRegion(P, M.getModuleIdentifier(), "module", [&M] {
+        unsigned Count = 0;
+        for (const Function &F : M)
+          Count += getInstructionCount(F);
+        return Count;
+      }) {}
+
+PassTraceRegion::PassTraceRegion(Pass *P, Function &F)
+    : PassTraceRegion(P, F, F.getName(), "function") {}
+
+PassTraceRegion::PassTraceRegion(Pass *P, Function &F, StringRef IRName,
+                                 const char *Category)
+    : PassTraceRegion(P, IRName, Category,
+                      [&F] { return getInstructionCount(F); }) {}
+
+PassTraceRegion::PassTraceRegion(Pass *P, BasicBlock &BB)
+    : PassTraceRegion(P, BB.getName(), "basicblock",
+                      [&BB] { return unsigned(BB.size()); }) {}
+
+PassTraceRegion::~PassTraceRegion() {
+  if (P)
+    TheTraceInfo->addEvent(P, IRName, Category, Start, InstCountBefore,
+                           CountInstructions());
+}
+
+/// Write \p Str as a JSON string.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+PassTraceInfo::~PassTraceInfo() {
+  std::error_code EC;
+  raw_fd_ostream OS(PassTraceFilename, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << "Error opening pass trace file '" << PassTraceFilename
+           << "': " << EC.message() << '\n';
+    return;
+  }
+
+  // Use "complete" events: the viewers nest the passes run by module passes
+  // (e.g. the inliner) under them according to their timestamps.
+  OS << "{\"traceEvents\":[";
+  for (unsigned I = 0, E = Events.size(); I != E; ++I) {
+    const TraceEvent &Event = Events[I];
+    OS << (I ? ",\n" : "\n") << "{\"name\":";
+    writeJSONString(OS, Event.PassName);
+    OS << ",\"cat\":\"" << Event.Category << "\",\"ph\":\"X\",\"pid\":1"
+       << ",\"tid\":" << Event.ThreadID << ",\"ts\":" << Event.Start
+       << ",\"dur\":" << Event.Duration << ",\"args\":{\"ir\":";
+    writeJSONString(OS, Event.IRName);
+    OS << ",\"instructions\":" << Event.InstCountAfter
+       << ",\"instructions_delta\":"
+       << int64_t(Event.InstCountAfter) - int64_t(Event.InstCountBefore)
+       << ",\"malloc\":" << Event.MallocUsage
+       << ",\"peak_malloc\":" << Event.PeakMallocUsage << "}}";
+  }
+  OS << "\n]}\n";
+}
+
 //===----------------------------------------------------------------------===//
 // PMStack implementation
 //
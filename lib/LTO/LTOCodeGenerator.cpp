@@ -13,6 +13,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/LTO/LTOCodeGenerator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
@@ -44,6 +46,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetLowering.h"
@@ -53,9 +56,25 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/ObjCARC.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include <system_error>
 using namespace llvm;
 
+#define DEBUG_TYPE "lto"
+
+STATISTIC(NumOptimizedPartitions,
+          "Number of module partitions optimized in parallel");
+
+// Parse a module partition serialized to bitcode into the context Ctx.
+static std::unique_ptr<Module> parsePartition(const SmallVector<char, 0> &BC,
+                                              LLVMContext &Ctx) {
+  ErrorOr<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+      MemoryBufferRef(StringRef(BC.data(), BC.size()), "<split-module>"), Ctx);
+  if (!MOrErr)
+    report_fatal_error("Failed to read bitcode");
+  return std::move(MOrErr.get());
+}
+
 const char* LTOCodeGenerator::getVersionString() {
 #ifdef LLVM_VERSION_INFO
   return PACKAGE_NAME " version " PACKAGE_VERSION ", " LLVM_VERSION_INFO;
@@ -520,6 +539,20 @@ bool LTOCodeGenerator::optimize(bool DisableVerify, bool DisableInline,
   PMB.VerifyInput = !DisableVerify;
   PMB.VerifyOutput = !DisableVerify;
 
+  if (OptParallelism > 1 && canOptimizeInParallel()) {
+    PMB.populateLTOInterproceduralPassManager(passes);
+    passes.run(*MergedModule);
+
+    optimizeScalarInParallel(PMB);
+
+    legacy::PassManager FinalPasses;
+    FinalPasses.add(createTargetTransformInfoWrapperPass(
+        TargetMach->getTargetIRAnalysis()));
+    PMB.populateLTOFinalPassManager(FinalPasses);
+    FinalPasses.run(*MergedModule);
+    return true;
+  }
+
   PMB.populateLTOPassManager(passes);
 
   // Run our queue of passes all at once now, efficiently.
@@ -528,6 +561,84 @@ bool LTOCodeGenerator::optimize(bool DisableVerify, bool DisableInline,
   return true;
 }
 
+/// Whether the merged module can be split to run the scalar passes on its
+/// partitions.
+bool LTOCodeGenerator::canOptimizeInParallel() {
+  if (OptLevel <= 1)
+    return false;
+
+  // The debug info metadata of the partitions would be duplicated when linking
+  // them back together, each one holding its own copy of the compile units.
+  return !MergedModule->getNamedMetadata("llvm.dbg.cu");
+}
+
+/// Run the scalar part of the LTO pipeline on OptParallelism partitions of the
+/// merged module, in parallel, and link the optimized partitions back into a
+/// new merged module.
+void LTOCodeGenerator::optimizeScalarInParallel(PassManagerBuilder &PMB) {
+  std::string ModuleID = MergedModule->getModuleIdentifier();
+  std::string TripleStr = MergedModule->getTargetTriple();
+  DataLayout DL = MergedModule->getDataLayout();
+
+  // The passes of a partition run in their own context, as an LLVMContext
+  // can't be used from several threads. Serialize the partitions to bitcode on
+  // the main thread, every local ends up in the partition of its users so that
+  // the linkage of the symbols is unchanged.
+  std::vector<SmallVector<char, 0>> PartitionsBC;
+  SplitModule(std::move(MergedModule), OptParallelism,
+              [&](std::unique_ptr<Module> MPart) {
+                PartitionsBC.emplace_back();
+                raw_svector_ostream BCOS(PartitionsBC.back());
+                WriteBitcodeToFile(MPart.get(), BCOS);
+              },
+              /* PreserveLocals */ true);
+
+  const Target &TheTarget = TargetMach->getTarget();
+  {
+    ThreadPool Pool(OptParallelism);
+    for (SmallVector<char, 0> &BC : PartitionsBC)
+      Pool.async([&] {
+        LLVMContext Ctx;
+        std::unique_ptr<Module> MPart = parsePartition(BC, Ctx);
+
+        // The target machine caches its subtargets, it can't be shared by the
+        // threads either.
+        std::unique_ptr<TargetMachine> TM(TheTarget.createTargetMachine(
+            TripleStr, MCpu, FeatureStr, Options, RelocModel,
+            CodeModel::Default, CGOptLevel));
+        legacy::PassManager Passes;
+        Passes.add(
+            createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
+        PMB.populateLTOScalarPassManager(Passes);
+        Passes.run(*MPart);
+
+        BC.clear();
+        raw_svector_ostream BCOS(BC);
+        WriteBitcodeToFile(MPart.get(), BCOS);
+        ++NumOptimizedPartitions;
+      });
+  }
+
+  MergedModule = make_unique<Module>(ModuleID, Context);
+  MergedModule->setTargetTriple(TripleStr);
+  MergedModule->setDataLayout(DL);
+  TheLinker = make_unique<Linker>(*MergedModule);
+  for (SmallVector<char, 0> &BC : PartitionsBC)
+    if (TheLinker->linkInModule(parsePartition(BC, Context)))
+      report_fatal_error("Failed to link optimized module partitions");
+
+  // Every partition carries the named metadata of the merged module, drop the
+  // duplicated operands.
+  for (NamedMDNode &NMD : MergedModule->named_metadata()) {
+    SetVector<MDNode *> Operands(NMD.op_begin(), NMD.op_end());
+    if (Operands.size() == NMD.getNumOperands())
+      continue;
+    NMD.dropAllReferences();
+    for (MDNode *Op : Operands)
+      NMD.addOperand(Op);
+  }
+}
+
 bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
   if (!this->determineTarget())
     return false;
@@ -0,0 +1,474 @@
+//===-ThinLTOCodeGenerator.cpp - LLVM Link Time Optimizer -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Thin Link Time Optimization library. This library is
+// intended to be used by linker to optimize code at link time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/LTO/ThinLTOCodeGenerator.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/DiagnosticPrinter.h"
+#include "llvm/IR/FunctionInfo.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Object/FunctionIndexObjectFile.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/FunctionImport.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "thinlto"
+
+static void diagnosticHandler(const DiagnosticInfo &DI) {
+  DiagnosticPrinterRawOStream DP(errs());
+  DI.print(DP);
+  errs() << '\n';
+}
+
+// Simple helper to load a module from bitcode
+static std::unique_ptr<Module>
+loadModuleFromBuffer(const MemoryBufferRef &Buffer, LLVMContext &Context,
+                     bool Lazy) {
+  ErrorOr<std::unique_ptr<Module>> ModuleOrErr(nullptr);
+  if (Lazy) {
+    ModuleOrErr =
+        getLazyBitcodeModule(MemoryBuffer::getMemBuffer(Buffer, false), Context,
+                             /* ShouldLazyLoadMetadata */ true);
+  } else {
+    ModuleOrErr = parseBitcodeFile(Buffer, Context);
+  }
+  if (std::error_code EC = ModuleOrErr.getError())
+    report_fatal_error("Can't load module '" + Buffer.getBufferIdentifier() +
+                       "': " + EC.message());
+  return std::move(ModuleOrErr.get());
+}
+
+static void promoteModule(Module &TheModule, const FunctionInfoIndex &Index) {
+  if (renameModuleForThinLTO(TheModule, &Index))
+    report_fatal_error("renameModuleForThinLTO failed");
+}
+
+// Load lazily the source module \p Identifier for importing into a module
+// living in \p Context.
+static std::unique_ptr<Module>
+loadModuleForImport(StringMap<MemoryBufferRef> &ModuleMap,
+                    StringRef Identifier, LLVMContext &Context) {
+  auto It = ModuleMap.find(Identifier);
+  if (It == ModuleMap.end())
+    report_fatal_error("Can't find module '" + Identifier +
+                       "' for import in the ThinLTO module map");
+  return loadModuleFromBuffer(It->second, Context, /* Lazy */ true);
+}
+
+static void crossImportIntoModule(Module &TheModule,
+                                  const FunctionInfoIndex &Index,
+                                  StringMap<MemoryBufferRef> &ModuleMap) {
+  // Each import loads its source module lazily, in the same context as the
+  // destination module.
+  auto ModuleLoader = [&](StringRef Identifier) {
+    return loadModuleForImport(ModuleMap, Identifier, TheModule.getContext());
+  };
+
+  FunctionImporter Importer(Index, ModuleLoader);
+  Importer.importFunctions(TheModule);
+}
+
+static void optimizeModule(Module &TheModule, TargetMachine &TM,
+                           unsigned OptLevel) {
+  // Populate the PassManager
+  PassManagerBuilder PMB;
+  PMB.LibraryInfo = new TargetLibraryInfoImpl(TM.getTargetTriple());
+  PMB.Inliner = createFunctionInliningPass();
+  // FIXME: should get it from the bitcode?
+  PMB.OptLevel = OptLevel;
+  PMB.LoopVectorize = true;
+  PMB.SLPVectorize = true;
+  PMB.VerifyInput = true;
+  PMB.VerifyOutput = false;
+
+  legacy::PassManager PM;
+
+  // Add the TTI (required to inform the vectorizer about register size for
+  // instance)
+  PM.add(createTargetTransformInfoWrapperPass(TM.getTargetIRAnalysis()));
+
+  // Add optimizations
+  PMB.populateModulePassManager(PM);
+
+  PM.run(TheModule);
+}
+
+/// Codegen a module, producing an object file in memory.
+static SmallVector<char, 0> codegenModule(Module &TheModule,
+                                          TargetMachine &TM) {
+  SmallVector<char, 0> OutputBuffer;
+
+  // CodeGen
+  {
+    raw_svector_ostream OS(OutputBuffer);
+    legacy::PassManager PM;
+    if (TM.addPassesToEmitFile(PM, OS, TargetMachine::CGFT_ObjectFile,
+                               /* DisableVerify */ true))
+      report_fatal_error("Failed to setup codegen");
+
+    // Run codegen now. resulting binary is in OutputBuffer.
+    PM.run(TheModule);
+  }
+  return OutputBuffer;
+}
+
+static SmallVector<char, 0>
+processThinLTOModule(Module &TheModule, const FunctionInfoIndex &Index,
+                     StringMap<MemoryBufferRef> &ModuleMap, TargetMachine &TM,
+                     unsigned OptLevel) {
+  // "Benchmark"-like optimization: single-source case
+  bool SingleModule = (ModuleMap.size() == 1);
+
+  if (!SingleModule) {
+    // Cross-module import of the functions selected by the summaries.
+    crossImportIntoModule(TheModule, Index, ModuleMap);
+  }
+
+  TheModule.setDataLayout(TM.createDataLayout());
+  optimizeModule(TheModule, TM, OptLevel);
+
+  return codegenModule(TheModule, TM);
+}
+
+// Hash the content of a buffer, returning the digest as an hex string.
+static std::string hashBuffer(StringRef Buffer) {
+  MD5 Hasher;
+  Hasher.update(Buffer);
+  MD5::MD5Result Result;
+  Hasher.final(Result);
+  SmallString<32> Digest;
+  MD5::stringifyResult(Result, Digest);
+  return Digest.str();
+}
+
+// Collect the modules defining, according to the combined index, the functions
+// that the module in \p ModuleBuffer declares. These are the modules it may
+// import from directly. Only the module-level records are read.
+static std::vector<StringRef>
+getDirectImportSources(const MemoryBufferRef &ModuleBuffer,
+                       const FunctionInfoIndex &Index) {
+  LLVMContext Context;
+  auto TheModule = loadModuleFromBuffer(ModuleBuffer, Context, /* Lazy */ true);
+  std::vector<StringRef> Sources;
+  for (Function &F : *TheModule) {
+    if (!F.isDeclaration() || F.isIntrinsic())
+      continue;
+    auto InfoList = Index.findFunctionInfoList(F.getName());
+    if (InfoList == Index.end() || InfoList->second.empty())
+      continue;
+    if (FunctionSummary *Summary = InfoList->second[0]->functionSummary())
+      Sources.push_back(Summary->modulePath());
+  }
+  return Sources;
+}
+
+namespace {
+/// Cache the object file produced by a ThinLTO backend in a directory. The
+/// entry is keyed by a hash of every input of the backend: the module itself,
+/// the modules functions may be imported from, the IDs of all these modules,
+/// which are part of the names of promoted locals, and the optimization and
+/// code generation options.
+class ModuleCacheEntry {
+  SmallString<128> EntryPath;
+
+public:
+  // Create a cache entry. This computes a unique hash for the Module, taking
+  // into account the modules it may import from and the code generation
+  // options. \p ImportSources must be sorted.
+  ModuleCacheEntry(StringRef CachePath, StringRef ModuleID,
+                   const FunctionInfoIndex &Index,
+                   const StringMap<std::string> &ModuleHashes,
+                   ArrayRef<StringRef> ImportSources,
+                   const TargetMachineBuilder &TMBuilder, unsigned OptLevel) {
+    if (CachePath.empty())
+      return;
+
+    MD5 Hasher;
+
+    // Start with the compiler revision and the options that drive the
+    // optimizer and the code generator.
+    std::string OptionsStr;
+    raw_string_ostream OS(OptionsStr);
+    const TargetOptions &Opts = TMBuilder.Options;
+    OS << LLVM_VERSION_STRING << ';' << TMBuilder.TheTriple.str() << ';'
+       << TMBuilder.MCpu << ';' << TMBuilder.MAttr << ';'
+       << (unsigned)TMBuilder.RelocModel << ';'
+       << (unsigned)TMBuilder.CGOptLevel << ';' << OptLevel << ';'
+       << Opts.UnsafeFPMath << Opts.NoInfsFPMath << Opts.NoNaNsFPMath
+       << Opts.HonorSignDependentRoundingFPMathOption << Opts.NoZerosInBSS
+       << Opts.GuaranteedTailCallOpt << Opts.EnableFastISel
+       << Opts.PositionIndependentExecutable << Opts.UseInitArray
+       << Opts.DisableIntegratedAS << Opts.CompressDebugSections
+       << Opts.FunctionSections << Opts.DataSections
+       << Opts.UniqueSectionNames << Opts.TrapUnreachable << Opts.EmulatedTLS
+       << ';' << Opts.StackAlignmentOverride << ';'
+       << (unsigned)Opts.FloatABIType << ';' << (unsigned)Opts.AllowFPOpFusion
+       << ';' << (unsigned)Opts.JTType << ';' << (unsigned)Opts.ThreadModel
+       << ';' << (unsigned)Opts.EABIVersion << ';'
+       << (unsigned)Opts.DebuggerTuning << ';';
+
+    // The module itself, then every module it may import from. The IDs depend
+    // on the order of the inputs.
+    OS << Index.getModuleId(ModuleID) << ';' << ModuleHashes.lookup(ModuleID)
+       << ';';
+    for (StringRef Source : ImportSources)
+      OS << Index.getModuleId(Source) << ';' << ModuleHashes.lookup(Source)
+         << ';';
+    Hasher.update(OS.str());
+
+    MD5::MD5Result Result;
+    Hasher.final(Result);
+    SmallString<32> Key;
+    MD5::stringifyResult(Result, Key);
+    sys::path::append(EntryPath, CachePath, "llvmcache-" + Key);
+  }
+
+  // Access the path to this entry in the cache.
+  StringRef getEntryPath() { return EntryPath; }
+
+  // Try loading the buffer for this cache entry. A hit refreshes the
+  // modification time of the entry, which is used as the last use time by
+  // the pruning.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> tryLoadingBuffer() {
+    if (EntryPath.empty())
+      return make_error_code(errc::no_such_file_or_directory);
+    auto BufferOrErr = MemoryBuffer::getFile(EntryPath);
+    if (!BufferOrErr)
+      return BufferOrErr;
+    int FD;
+    if (!sys::fs::openFileForWrite(EntryPath, FD, sys::fs::F_Append)) {
+      sys::fs::setLastModificationAndAccessTime(FD, sys::TimeValue::now());
+      sys::Process::SafelyCloseFileDescriptor(FD);
+    }
+    return BufferOrErr;
+  }
+
+  // Cache the produced object file. The content is written to a temporary
+  // file first and renamed atomically, so that a concurrent reader never sees
+  // a partial entry.
+  void write(ArrayRef<char> OutputBuffer) {
+    if (EntryPath.empty())
+      return;
+    SmallString<128> TempFilename;
+    int TempFD;
+    std::error_code EC =
+        sys::fs::createUniqueFile(EntryPath + ".tmp%%%%%%", TempFD,
+                                  TempFilename);
+    if (EC) {
+      errs() << "warning: can't create a temporary file in the ThinLTO cache: "
+             << EC.message() << "\n";
+      return;
+    }
+    {
+      raw_fd_ostream OS(TempFD, /* ShouldClose */ true);
+      OS << StringRef(OutputBuffer.data(), OutputBuffer.size());
+    }
+    if (sys::fs::rename(TempFilename, EntryPath))
+      sys::fs::remove(TempFilename);
+  }
+};
+} // end anonymous namespace
+
+// Create the TargetMachine from the builder parameters.
+std::unique_ptr<TargetMachine> TargetMachineBuilder::create() const {
+  std::string ErrMsg;
+  const Target *TheTarget =
+      TargetRegistry::lookupTarget(TheTriple.str(), ErrMsg);
+  if (!TheTarget)
+    report_fatal_error("Can't load target for this Triple: " + ErrMsg);
+
+  // Use MAttr as the default set of features.
+  SubtargetFeatures Features(MAttr);
+  Features.getDefaultSubtargetFeatures(TheTriple);
+  std::string FeatureStr = Features.getString();
+  return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+      TheTriple.str(), MCpu, FeatureStr, Options, RelocModel,
+      CodeModel::Default, CGOptLevel));
+}
+
+void ThinLTOCodeGenerator::addModule(StringRef Identifier, StringRef Data) {
+  MemoryBufferRef Buffer(Data, Identifier);
+  if (Modules.empty()) {
+    // First module added, so initialize the triple and some options
+    LLVMContext Context;
+    Triple TheTriple(getBitcodeTargetTriple(Buffer, Context));
+    TMBuilder.TheTriple = std::move(TheTriple);
+  }
+#ifndef NDEBUG
+  else {
+    LLVMContext Context;
+    assert(TMBuilder.TheTriple.str() ==
+               getBitcodeTargetTriple(Buffer, Context) &&
+           "ThinLTO modules with different triple not supported");
+  }
+#endif
+  Modules.push_back(Buffer);
+}
+
+/// Produce the combined function index from all the bitcode files:
+/// "thin-link".
+std::unique_ptr<FunctionInfoIndex> ThinLTOCodeGenerator::linkCombinedIndex() {
+  auto CombinedIndex = llvm::make_unique<FunctionInfoIndex>();
+  uint64_t NextModuleId = 0;
+  for (auto &ModuleBuffer : Modules) {
+    // Skip modules without a function summary.
+    if (!object::FunctionIndexObjectFile::hasFunctionSummaryInMemBuffer(
+            ModuleBuffer, diagnosticHandler))
+      continue;
+    ErrorOr<std::unique_ptr<object::FunctionIndexObjectFile>> ObjOrErr =
+        object::FunctionIndexObjectFile::create(ModuleBuffer,
+                                                diagnosticHandler, false);
+    if (std::error_code EC = ObjOrErr.getError()) {
+      errs() << "error: can't create FunctionIndexObjectFile for buffer '"
+             << ModuleBuffer.getBufferIdentifier() << "': " << EC.message()
+             << "\n";
+      return nullptr;
+    }
+    CombinedIndex->mergeFrom((*ObjOrErr)->takeIndex(), ++NextModuleId);
+  }
+  return CombinedIndex;
+}
+
+// Main entry point for the ThinLTO processing
+void ThinLTOCodeGenerator::run() {
+  // Sequential linking phase
+  auto Index = linkCombinedIndex();
+  if (!Index)
+    report_fatal_error("ThinLTO: can't link the combined index");
+
+  // Prepare the resulting object vector
+  assert(ProducedBinaries.empty() && "The generator should not be reused");
+  ProducedBinaries.resize(Modules.size());
+
+  // Prepare the module map.
+  StringMap<MemoryBufferRef> ModuleMap;
+  for (auto &ModuleBuffer : Modules)
+    ModuleMap[ModuleBuffer.getBufferIdentifier()] = ModuleBuffer;
+
+  // "Benchmark"-like optimization: single-source case
+  bool SingleModule = (Modules.size() == 1);
+
+  // When caching, the content of every module participates in the keys, hash
+  // them once upfront. The key of a module also covers all the modules it may
+  // import from, transitively, so that a hit doesn't need to compute the
+  // actual imports, which requires parsing the module.
+  StringMap<std::string> ModuleHashes;
+  StringMap<std::vector<StringRef>> ImportSources;
+  if (!CacheOptions.Path.empty()) {
+    StringMap<std::vector<StringRef>> DirectSources;
+    for (auto &ModuleBuffer : Modules) {
+      StringRef ModuleID = ModuleBuffer.getBufferIdentifier();
+      ModuleHashes[ModuleID] = hashBuffer(ModuleBuffer.getBuffer());
+      if (!SingleModule)
+        DirectSources[ModuleID] = getDirectImportSources(ModuleBuffer, *Index);
+    }
+    for (auto &Entry : DirectSources) {
+      StringSet<> Visited;
+      Visited.insert(Entry.first());
+      SmallVector<StringRef, 8> Worklist(Entry.second.begin(),
+                                         Entry.second.end());
+      std::vector<StringRef> &Sources = ImportSources[Entry.first()];
+      while (!Worklist.empty()) {
+        StringRef Source = Worklist.pop_back_val();
+        if (!Visited.insert(Source).second)
+          continue;
+        Sources.push_back(Source);
+        auto It = DirectSources.find(Source);
+        if (It != DirectSources.end())
+          Worklist.append(It->second.begin(), It->second.end());
+      }
+      std::sort(Sources.begin(), Sources.end());
+    }
+  }
+
+  // Parallel optimizer + codegen. Each module gets its own LLVMContext and
+  // TargetMachine so that the backends do not share any mutable state. The
+  // combined index and the module map are only read.
+  {
+    std::unique_ptr<ThreadPool> Pool =
+        ThreadCount ? llvm::make_unique<ThreadPool>(ThreadCount)
+                    : llvm::make_unique<ThreadPool>();
+    unsigned Count = 0;
+    for (auto &ModuleBuffer : Modules) {
+      Pool->async([&](unsigned ModuleNum) {
+        StringRef ModuleID = ModuleBuffer.getBufferIdentifier();
+        ModuleCacheEntry CacheEntry(CacheOptions.Path, ModuleID, *Index,
+                                    ModuleHashes,
+                                    ImportSources.lookup(ModuleID), TMBuilder,
+                                    OptLevel);
+        // If another process is producing the same entry, wait for it rather
+        // than duplicating the work. Otherwise hold the lock while producing
+        // the entry.
+        std::unique_ptr<LockFileManager> Lock;
+        auto CachedBuffer = CacheEntry.tryLoadingBuffer();
+        if (!CachedBuffer && !CacheEntry.getEntryPath().empty()) {
+          Lock = llvm::make_unique<LockFileManager>(CacheEntry.getEntryPath());
+          if (Lock->getState() == LockFileManager::LFS_Shared) {
+            Lock->waitForUnlock();
+            CachedBuffer = CacheEntry.tryLoadingBuffer();
+          }
+        }
+        if (CachedBuffer) {
+          DEBUG(dbgs() << "Cache hit for " << ModuleID << ": "
+                       << CacheEntry.getEntryPath() << "\n");
+          StringRef Cached = (*CachedBuffer)->getBuffer();
+          ProducedBinaries[ModuleNum].append(Cached.begin(), Cached.end());
+          return;
+        }
+
+        // Parse module now
+        LLVMContext Context;
+        auto TheModule = loadModuleFromBuffer(ModuleBuffer, Context, false);
+        if (!SingleModule)
+          promoteModule(*TheModule, *Index);
+
+        auto TM = TMBuilder.create();
+        ProducedBinaries[ModuleNum] =
+            processThinLTOModule(*TheModule, *Index, ModuleMap, *TM, OptLevel);
+        CacheEntry.write(ProducedBinaries[ModuleNum]);
+      }, Count);
+      Count++;
+    }
+  }
+
+  // Prune the cache now that the backends are done.
+  CachePruning(CacheOptions.Path)
+      .setPruningInterval(CacheOptions.PruningInterval)
+      .setEntryExpiration(CacheOptions.Expiration)
+      .setMaxSize(CacheOptions.MaxSize)
+      .prune();
+}
@@ -695,10 +695,14 @@ bool ModuleLinker::linkIfNeeded(GlobalValue &GV) {
 }
 
 void ModuleLinker::addLazyFor(GlobalValue &GV, IRMover::ValueAdder Add) {
-  // Add these to the internalize list
-  if (!GV.hasLinkOnceLinkage())
+  // Linkonce values are only linked if they are referenced. With
+  // -only-needed, so is everything else: the definitions reachable from the
+  // needed values are linked, and the bodies of the others are never
+  // materialized.
+  if (!GV.hasLinkOnceLinkage() && !shouldLinkOnlyNeeded())
     return;
 
+  // The value is referenced: link it, along with the rest of its comdat.
   if (shouldInternalizeLinkedSymbols())
     Internalize.insert(GV.getName());
   Add(GV);
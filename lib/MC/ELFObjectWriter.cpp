@@ -883,6 +883,7 @@ void ELFObjectWriter::computeSymbolTable(
   for (const std::string &Name : FileNames)
     StrTabBuilder.add(Name);
 
+  StrTabBuilder.setParallelism(Asm.getLayoutThreads());
   StrTabBuilder.finalize();
 
   for (const std::string &Name : FileNames)
@@ -29,7 +29,9 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <tuple>
 using namespace llvm;
 
@@ -68,8 +70,9 @@ STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
 MCAssembler::MCAssembler(MCContext &Context_, MCAsmBackend &Backend_,
                          MCCodeEmitter &Emitter_, MCObjectWriter &Writer_)
     : Context(Context_), Backend(Backend_), Emitter(Emitter_), Writer(Writer_),
-      BundleAlignSize(0), RelaxAll(false), SubsectionsViaSymbols(false),
-      IncrementalLinkerCompatible(false), ELFHeaderEFlags(0) {
+      BundleAlignSize(0), LayoutThreads(1), RelaxAll(false),
+      SubsectionsViaSymbols(false), IncrementalLinkerCompatible(false),
+      ELFHeaderEFlags(0) {
   VersionMinInfo.Major = 0; // Major version == 0 for "none specified"
 }
 
@@ -651,7 +654,9 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
       Frag.setLayoutOrder(FragmentIndex++);
   }
 
-  // Layout until everything fits.
+  // Relax the sections which don't depend on each other in parallel, then
+  // layout until everything fits.
+  layoutIndependentSections(Layout);
   while (layoutOnce(Layout))
     continue;
 
@@ -762,7 +767,11 @@ bool MCAssembler::relaxInstruction(MCAsmLayout &Layout,
   SmallVector<MCFixup, 4> Fixups;
   SmallString<256> Code;
   raw_svector_ostream VecOS(Code);
-  getEmitter().encodeInstruction(Relaxed, VecOS, Fixups, F.getSubtargetInfo());
+  {
+    sys::ScopedLock Guard(EmitterLock);
+    getEmitter().encodeInstruction(Relaxed, VecOS, Fixups,
+                                   F.getSubtargetInfo());
+  }
 
   // Update the fragment.
   F.setInst(Relaxed);
@@ -874,6 +883,93 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   return false;
 }
 
+/// Check whether \p Expr refers to a symbol whose value is an expression, or
+/// to a target specific expression we can't look into.
+static bool refersToVariableSymbol(const MCExpr &Expr) {
+  switch (Expr.getKind()) {
+  case MCExpr::Constant:
+    return false;
+  case MCExpr::SymbolRef:
+    return cast<MCSymbolRefExpr>(Expr).getSymbol().isVariable();
+  case MCExpr::Unary:
+    return refersToVariableSymbol(*cast<MCUnaryExpr>(Expr).getSubExpr());
+  case MCExpr::Binary: {
+    const MCBinaryExpr &BE = cast<MCBinaryExpr>(Expr);
+    return refersToVariableSymbol(*BE.getLHS()) ||
+           refersToVariableSymbol(*BE.getRHS());
+  }
+  case MCExpr::Target:
+    return true;
+  }
+  llvm_unreachable("Invalid expression kind!");
+}
+
+/// Check whether the symbol referenced by \p Ref is undefined or defined in
+/// \p Sec, so that evaluating it doesn't layout another section.
+static bool isUndefinedOrInSection(const MCSymbolRefExpr *Ref,
+                                   const MCSection &Sec) {
+  if (!Ref)
+    return true;
+  const MCSymbol &Sym = Ref->getSymbol();
+  if (!Sym.isDefined())
+    return true;
+  return Sym.getFragment()->getParent() == &Sec;
+}
+
+bool MCAssembler::canLayoutSectionIndependently(const MCSection &Sec) const {
+  for (const MCFragment &F : Sec) {
+    switch (F.getKind()) {
+    case MCFragment::FT_Data:
+    case MCFragment::FT_CompactEncodedInst:
+    case MCFragment::FT_Fill:
+    case MCFragment::FT_Align:
+    case MCFragment::FT_SafeSEH:
+      break;
+    case MCFragment::FT_Relaxable:
+      // Evaluating a fixup computes the offsets of the symbols it refers to,
+      // which must not be owned by another thread.
+      for (const MCFixup &Fixup : cast<MCRelaxableFragment>(F).getFixups()) {
+        MCValue Target;
+        if (refersToVariableSymbol(*Fixup.getValue()) ||
+            !Fixup.getValue()->evaluateAsRelocatable(Target, nullptr,
+                                                     nullptr) ||
+            !isUndefinedOrInSection(Target.getSymA(), Sec) ||
+            !isUndefinedOrInSection(Target.getSymB(), Sec))
+          return false;
+      }
+      break;
+    default:
+      // The size of the DWARF, CodeView, LEB and org fragments is computed
+      // from expressions which may refer to any section.
+      return false;
+    }
+  }
+  return true;
+}
+
+void MCAssembler::layoutIndependentSections(MCAsmLayout &Layout) {
+  if (LayoutThreads <= 1 || !getBackend().allowsParallelRelaxation())
+    return;
+
+  SmallVector<MCSection *, 16> Independent;
+  for (MCSection &Sec : *this)
+    if (canLayoutSectionIndependently(Sec))
+      Independent.push_back(&Sec);
+  if (Independent.size() < 2)
+    return;
+
+  // Each task only lays out its own section, the serial iterations which
+  // follow will find these sections already relaxed.
+  ThreadPool Pool(std::min<unsigned>(LayoutThreads, Independent.size()));
+  for (MCSection *Sec : Independent)
+    Pool.async([this, &Layout, Sec] {
+      while (layoutSectionOnce(Layout, *Sec))
+        continue;
+      Layout.getFragmentOffset(&*Sec->rbegin());
+    });
+  Pool.wait();
+}
+
 bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
   ++stats::RelaxationSteps;
 
@@ -38,6 +38,11 @@ MCAsmLayout::MCAsmLayout(MCAssembler &Asm)
   for (MCSection &Sec : Asm)
     if (Sec.isVirtualSection())
       SectionOrder.push_back(&Sec);
+
+  // Create the entries of all the sections up front, so that the layout of
+  // different sections can be updated concurrently without growing the map.
+  for (MCSection &Sec : Asm)
+    LastValidFragment[&Sec] = nullptr;
 }
 
 bool MCAsmLayout::isFragmentValid(const MCFragment *F) const {
@@ -17,7 +17,7 @@ MCTargetOptions::MCTargetOptions()
       MCFatalWarnings(false), MCNoWarn(false), MCSaveTempLabels(false),
       MCUseDwarfDirectory(false), MCIncrementalLinkerCompatible(false),
       ShowMCEncoding(false), ShowMCInst(false), AsmVerbose(false),
-      DwarfVersion(0), ABIName() {}
+      DwarfVersion(0), MCLayoutThreads(1), ABIName() {}
 
 StringRef MCTargetOptions::getABIName() const {
   return ABIName;
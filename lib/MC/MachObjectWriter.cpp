@@ -520,6 +520,7 @@ void MachObjectWriter::computeSymbolTable(
 
     StringTable.add(Symbol.getName());
   }
+  StringTable.setParallelism(Asm.getLayoutThreads());
   StringTable.finalize();
 
   // Build the symbol arrays but only for non-local symbols.
@@ -11,7 +11,9 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/COFF.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/ThreadPool.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace llvm;
@@ -76,6 +78,56 @@ tailcall:
   }
 }
 
+// The number of strings from which the tail merging sort runs in parallel.
+static const size_t ParallelSortThreshold = 1 << 14;
+
+// The number of partitions of the parallel sort, one per pair of last two
+// characters, where each character is either a byte or the end of the string.
+static const unsigned NumTailKeys = 257 * 257;
+
+// Returns the partition of a string in the parallel sort. Partitions are
+// numbered in the order multikey_qsort puts the strings in: greater
+// characters first, and the end of the string last.
+static unsigned tailKey(StringPair *P) {
+  return (255 - charTailAt(P, 0)) * 257 + (255 - charTailAt(P, 1));
+}
+
+// Sorts the strings in the same order as multikey_qsort(Begin, End, 0). The
+// strings are distributed by their last two characters, then the partitions
+// are sorted on a thread pool in chunks of roughly equal size.
+static void parallel_multikey_qsort(std::vector<StringPair *> &Strings,
+                                    unsigned Threads) {
+  // Begin[K] is the index of the first string of partition K in the result.
+  std::vector<size_t> Begin(NumTailKeys + 1);
+  for (StringPair *P : Strings)
+    ++Begin[tailKey(P) + 1];
+  for (unsigned K = 0; K != NumTailKeys; ++K)
+    Begin[K + 1] += Begin[K];
+
+  std::vector<StringPair *> Sorted(Strings.size());
+  std::vector<size_t> Next(Begin.begin(), Begin.end() - 1);
+  for (StringPair *P : Strings)
+    Sorted[Next[tailKey(P)]++] = P;
+
+  ThreadPool Pool(Threads);
+  StringPair **Base = Sorted.data();
+  size_t ChunkSize = std::max<size_t>(Strings.size() / (Threads * 8), 1);
+  for (unsigned K = 0; K != NumTailKeys;) {
+    unsigned First = K++;
+    while (K != NumTailKeys && Begin[K + 1] - Begin[First] <= ChunkSize)
+      ++K;
+    unsigned Last = K;
+    Pool.async([&Begin, Base, First, Last] {
+      // All the strings of a partition share their last two characters.
+      for (unsigned I = First; I != Last; ++I)
+        multikey_qsort(Base + Begin[I], Base + Begin[I + 1], 2);
+    });
+  }
+  Pool.wait();
+
+  Strings = std::move(Sorted);
+}
+
 void StringTableBuilder::finalize() {
   finalizeStringTable(/*Optimize=*/true);
 }
@@ -94,7 +146,10 @@ void StringTableBuilder::finalizeStringTable(bool Optimize) {
   if (!Strings.empty()) {
     // If we're optimizing, sort by name. If not, sort by previously assigned
     // offset.
-    if (Optimize) {
+    if (Optimize && Parallelism > 1 &&
+        Strings.size() >= ParallelSortThreshold) {
+      parallel_multikey_qsort(Strings, Parallelism);
+    } else if (Optimize) {
       multikey_qsort(&Strings[0], &Strings[0] + Strings.size(), 0);
     } else {
       std::sort(Strings.begin(), Strings.end(),
@@ -858,6 +858,7 @@ void WinCOFFObjectWriter::writeObject(MCAssembler &Asm,
   for (const auto &S : Symbols)
     if (S->Name.size() > COFF::NameSize)
       Strings.add(S->Name);
+  Strings.setParallelism(Asm.getLayoutThreads());
   Strings.finalize();
 
   // Set names.
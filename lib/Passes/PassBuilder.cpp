@@ -16,6 +16,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Passes/PassBuilder.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/CGSCCPassManager.h"
 #include "llvm/Analysis/LazyCallGraph.h"
@@ -119,8 +120,80 @@ void PassBuilder::registerFunctionAnalyses(FunctionAnalysisManager &FAM) {
 #include "PassRegistry.def"
 }
 
+FunctionPassManager
+PassBuilder::buildFunctionSimplificationPipeline(OptimizationLevel Level,
+                                                bool DebugLogging) {
+  assert(Level != O0 && "Must request optimizations!");
+  FunctionPassManager FPM(DebugLogging);
+
+  // Break up aggregate allocas and catch trivial redundancies.
+  FPM.addPass(SROA());
+  FPM.addPass(EarlyCSEPass());
+  FPM.addPass(SimplifyCFGPass());
+  FPM.addPass(InstCombinePass());
+
+  // FIXME: The loop passes, GVN at O2 and above, and the other scalar passes
+  // of PassManagerBuilder go here once they are ported to the new pass
+  // manager.
+
+  // Delete dead instructions and clean up after everything.
+  FPM.addPass(ADCEPass());
+  FPM.addPass(SimplifyCFGPass());
+  FPM.addPass(InstCombinePass());
+  return FPM;
+}
+
+ModulePassManager
+PassBuilder::buildPerModuleDefaultPipeline(OptimizationLevel Level,
+                                           bool DebugLogging) {
+  ModulePassManager MPM(DebugLogging);
+
+  // Allow forcing function attributes as a debugging and tuning aid.
+  MPM.addPass(ForceFunctionAttrsPass());
+  if (Level == O0)
+    return MPM;
+
+  // Infer attributes about declarations if possible.
+  MPM.addPass(InferFunctionAttrsPass());
+
+  // Early cleanups of every function, as done by the function pass manager
+  // of the frontends.
+  FunctionPassManager EarlyFPM(DebugLogging);
+  EarlyFPM.addPass(SimplifyCFGPass());
+  EarlyFPM.addPass(SROA());
+  EarlyFPM.addPass(EarlyCSEPass());
+  EarlyFPM.addPass(LowerExpectIntrinsicPass());
+  MPM.addPass(createModuleToFunctionPassAdaptor(std::move(EarlyFPM)));
+
+  // FIXME: The interprocedural passes and the inliner go here once they are
+  // ported. Until then, the simplification pipeline is run on each function
+  // without walking the call graph.
+  MPM.addPass(createModuleToFunctionPassAdaptor(
+      buildFunctionSimplificationPipeline(Level, DebugLogging)));
+
+  MPM.addPass(StripDeadPrototypesPass());
+  return MPM;
+}
+
+/// Parse the optimization level of a "default<...>" pipeline name.
+static Optional<PassBuilder::OptimizationLevel>
+parseDefaultPipelineName(StringRef Name) {
+  if (!Name.startswith("default<") || !Name.endswith(">"))
+    return None;
+  StringRef Level = Name.drop_front(strlen("default<")).drop_back(1);
+  return StringSwitch<Optional<PassBuilder::OptimizationLevel>>(Level)
+      .Case("O0", PassBuilder::O0)
+      .Case("O1", PassBuilder::O1)
+      .Case("O2", PassBuilder::O2)
+      .Case("O3", PassBuilder::O3)
+      .Default(None);
+}
+
 #ifndef NDEBUG
 static bool isModulePassName(StringRef Name) {
+  if (parseDefaultPipelineName(Name))
+    return true;
+
 #define MODULE_PASS(NAME, CREATE_PASS) if (Name == NAME) return true;
 #define MODULE_ANALYSIS(NAME, CREATE_PASS)                                     \
   if (Name == "require<" NAME ">" || Name == "invalidate<" NAME ">")           \
@@ -151,7 +224,13 @@ static bool isFunctionPassName(StringRef Name) {
   return false;
 }
 
-bool PassBuilder::parseModulePassName(ModulePassManager &MPM, StringRef Name) {
+bool PassBuilder::parseModulePassName(ModulePassManager &MPM, StringRef Name,
+                                      bool DebugLogging) {
+  if (Optional<OptimizationLevel> Level = parseDefaultPipelineName(Name)) {
+    MPM.addPass(buildPerModuleDefaultPipeline(*Level, DebugLogging));
+    return true;
+  }
+
 #define MODULE_PASS(NAME, CREATE_PASS)                                         \
   if (Name == NAME) {                                                          \
     MPM.addPass(CREATE_PASS);                                                  \
@@ -355,7 +434,7 @@ bool PassBuilder::parseModulePassPipeline(ModulePassManager &MPM,
     } else {
       // Otherwise try to parse a pass name.
       size_t End = PipelineText.find_first_of(",)");
-      if (!parseModulePassName(MPM, PipelineText.substr(0, End)))
+      if (!parseModulePassName(MPM, PipelineText.substr(0, End), DebugLogging))
         return false;
       if (VerifyEachPass)
         MPM.addPass(VerifierPass());
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include <cassert>
 
@@ -68,8 +69,12 @@ InstrProfReader::create(std::unique_ptr<MemoryBuffer> Buffer) {
 
 ErrorOr<std::unique_ptr<IndexedInstrProfReader>>
 IndexedInstrProfReader::create(std::string Path) {
-  // Set up the buffer to read.
-  auto BufferOrError = setupMemoryBuffer(Path);
+  // Set up the buffer to read. The indexed format doesn't need a null
+  // terminator, which lets the file be memory mapped whatever its size: only
+  // the pages holding the header and the looked up records are read in.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrError =
+      MemoryBuffer::getFileOrSTDIN(Path, /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
   if (std::error_code EC = BufferOrError.getError())
     return EC;
   return IndexedInstrProfReader::create(std::move(BufferOrError.get()));
@@ -640,11 +645,32 @@ InstrProfSymtab &IndexedInstrProfReader::getSymtab() {
   return *Symtab.get();
 }
 
+std::error_code
+IndexedInstrProfReader::getRecords(StringRef FuncName,
+                                   ArrayRef<InstrProfRecord> &Data) {
+  CachedFunction &Entry =
+      RecordCache[hash_value(FuncName) % RecordCacheSize];
+  if (!Entry.Records.empty() && Entry.FuncName == FuncName) {
+    Data = Entry.Records;
+    return instrprof_error::success;
+  }
+
+  std::error_code EC = Index->getRecords(FuncName, Data);
+  if (EC != instrprof_error::success)
+    return EC;
+
+  // Evict the previous occupant of the entry.
+  Entry.FuncName = FuncName;
+  Entry.Records.assign(Data.begin(), Data.end());
+  Data = Entry.Records;
+  return instrprof_error::success;
+}
+
 ErrorOr<InstrProfRecord>
 IndexedInstrProfReader::getInstrProfRecord(StringRef FuncName,
                                            uint64_t FuncHash) {
   ArrayRef<InstrProfRecord> Data;
-  std::error_code EC = Index->getRecords(FuncName, Data);
+  std::error_code EC = getRecords(FuncName, Data);
   if (EC != instrprof_error::success)
     return EC;
   // Found it. Look for counters with the right hash.
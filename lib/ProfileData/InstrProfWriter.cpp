@@ -184,6 +184,17 @@ std::error_code InstrProfWriter::addRecord(InstrProfRecord &&I,
   return Result;
 }
 
+void InstrProfWriter::mergeRecordsFromWriter(
+    InstrProfWriter &&IPW,
+    function_ref<void(std::error_code, StringRef)> Warn) {
+  // The counts of IPW have already been scaled by their weight.
+  for (auto &I : IPW.FunctionData)
+    for (auto &Func : I.getValue())
+      if (std::error_code EC = addRecord(std::move(Func.second), 1))
+        Warn(EC, I.getKey());
+  IPW.FunctionData.clear();
+}
+
 bool InstrProfWriter::shouldEncodeData(const ProfilingData &PD) {
   if (!Sparse)
     return true;
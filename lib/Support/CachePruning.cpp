@@ -0,0 +1,146 @@
+//===-CachePruning.cpp - LLVM Cache Directory Pruning ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the pruning of a directory based on least recently used.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/CachePruning.h"
+
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <vector>
+
+#define DEBUG_TYPE "cache-pruning"
+
+using namespace llvm;
+
+/// Write a new timestamp file with the given path. This is used for the pruning
+/// interval option.
+static void writeTimestampFile(StringRef TimestampFile) {
+  std::error_code EC;
+  raw_fd_ostream Out(TimestampFile.str(), EC, sys::fs::F_None);
+}
+
+/// Prune the cache of files that haven't been accessed in a long time.
+bool CachePruning::prune() {
+  if (Path.empty())
+    return false;
+
+  bool isPathDir;
+  if (sys::fs::is_directory(Path, isPathDir))
+    return false;
+
+  if (!isPathDir)
+    return false;
+
+  if (Expiration == 0 && MaxSize == 0) {
+    DEBUG(dbgs() << "No pruning settings set, exit early\n");
+    // Nothing will be pruned, early exit
+    return false;
+  }
+
+  // Try to stat() the timestamp file.
+  SmallString<128> TimestampFile(Path);
+  sys::path::append(TimestampFile, "llvmcache.timestamp");
+  sys::fs::file_status FileStatus;
+  sys::TimeValue CurrentTime = sys::TimeValue::now();
+  if (!sys::fs::status(TimestampFile, FileStatus)) {
+    if (Interval) {
+      // Check whether the time stamp is older than our pruning interval.
+      // If not, do nothing.
+      sys::TimeValue TimeElapsed =
+          CurrentTime - FileStatus.getLastModificationTime();
+      if (TimeElapsed.seconds() < Interval) {
+        DEBUG(dbgs() << "Timestamp file too recent (" << TimeElapsed.seconds()
+                     << "s < " << Interval << "s), skip pruning\n");
+        return false;
+      }
+    }
+  }
+
+  // Several processes may share the cache directory, only one of them prunes
+  // at a given time. The others just skip: the owner does the work for them.
+  LockFileManager Locked(TimestampFile);
+  if (Locked.getState() != LockFileManager::LFS_Owned) {
+    DEBUG(dbgs() << "Cache directory is being pruned by another process\n");
+    return false;
+  }
+
+  // Write a new timestamp file so that nobody else attempts to prune.
+  writeTimestampFile(TimestampFile);
+
+  struct CacheEntry {
+    std::string Path;
+    sys::TimeValue LastUse;
+    uint64_t Size;
+  };
+  std::vector<CacheEntry> Entries;
+  uint64_t TotalSize = 0;
+
+  // Walk the entire directory cache, looking for unused files.
+  std::error_code EC;
+  for (sys::fs::directory_iterator File(Path, EC), FileEnd;
+       File != FileEnd && !EC; File.increment(EC)) {
+    // Only consider the entries created by the cache users, this skips the
+    // timestamp file. Lock files and the temporary files of entries being
+    // written are left to their owner.
+    StringRef Filename = sys::path::filename(File->path());
+    if (!Filename.startswith("llvmcache-") || Filename.endswith(".lock") ||
+        Filename.find(".lock-") != StringRef::npos ||
+        Filename.find(".tmp") != StringRef::npos)
+      continue;
+
+    // Look at this file. If we can't stat it, there's nothing interesting
+    // there.
+    if (sys::fs::status(File->path(), FileStatus)) {
+      DEBUG(dbgs() << "Ignore " << File->path() << " (can't stat)\n");
+      continue;
+    }
+
+    // If the file hasn't been used recently enough, delete it. Cache hits
+    // refresh the modification time of the entries they read.
+    sys::TimeValue FileAccessTime = FileStatus.getLastModificationTime();
+    sys::TimeValue TimeElapsed = CurrentTime - FileAccessTime;
+    if (Expiration && TimeElapsed.seconds() > Expiration) {
+      DEBUG(dbgs() << "Remove " << File->path() << " ("
+                   << TimeElapsed.seconds() << "s old)\n");
+      sys::fs::remove(File->path());
+      continue;
+    }
+
+    // Leave it here for now, but add it to the list of size-based pruning.
+    TotalSize += FileStatus.getSize();
+    Entries.push_back({File->path(), FileAccessTime, FileStatus.getSize()});
+  }
+
+  // Prune for size now if needed, least recently used entries first.
+  if (MaxSize && TotalSize > MaxSize) {
+    std::sort(Entries.begin(), Entries.end(),
+              [](const CacheEntry &LHS, const CacheEntry &RHS) {
+                return LHS.LastUse < RHS.LastUse;
+              });
+    for (const CacheEntry &Entry : Entries) {
+      if (TotalSize <= MaxSize)
+        break;
+      DEBUG(dbgs() << "Remove " << Entry.Path << " (" << Entry.Size
+                   << " bytes, cache size " << TotalSize << " > " << MaxSize
+                   << ")\n");
+      sys::fs::remove(Entry.Path);
+      TotalSize -= Entry.Size;
+    }
+  }
+  return true;
+}
@@ -7,97 +7,217 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file implements a crude C++11 based thread pool.
+// This file implements a C++11 based work-stealing thread pool.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/ThreadPool.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+/// The pool the current thread belongs to, if any, and the index of its deque.
+static LLVM_THREAD_LOCAL ThreadPool *CurrentPool = nullptr;
+static LLVM_THREAD_LOCAL unsigned CurrentQueue = 0;
+
+void ThreadPool::push(PackagedTaskTy Task) {
+  ++UnfinishedTasks;
+  unsigned QueueID = (CurrentPool == this)
+                         ? CurrentQueue
+                         : NextQueue.fetch_add(1) % Queues.size();
+  {
+    WorkerQueue &Queue = *Queues[QueueID];
+    std::unique_lock<std::mutex> LockGuard(Queue.Lock);
+    Queue.Tasks.push_back(std::move(Task));
+  }
+  ++QueuedTasks;
+  // Only wake a thread if one sleeps. A thread counts itself as idle before
+  // checking QueuedTasks, and we check IdleThreads after incrementing it, so
+  // either it sees the task or we see it. Taking the lock makes sure it is
+  // blocked on the condition, and not about to, when we notify it.
+  if (IdleThreads.load() > 0) {
+    { std::unique_lock<std::mutex> LockGuard(QueueLock); }
+    QueueCondition.notify_one();
+  }
+}
+
+bool ThreadPool::pop(unsigned QueueID, PackagedTaskTy &Task) {
+  // Pop the most recent task from our own deque first: it is the most likely
+  // to find its data in cache.
+  {
+    WorkerQueue &Queue = *Queues[QueueID];
+    std::unique_lock<std::mutex> LockGuard(Queue.Lock);
+    if (!Queue.Tasks.empty()) {
+      Task = std::move(Queue.Tasks.back());
+      Queue.Tasks.pop_back();
+      --QueuedTasks;
+      return true;
+    }
+  }
+  // Steal the oldest task from another deque.
+  for (unsigned I = 1, E = Queues.size(); I < E; ++I) {
+    WorkerQueue &Queue = *Queues[(QueueID + I) % E];
+    std::unique_lock<std::mutex> LockGuard(Queue.Lock);
+    if (!Queue.Tasks.empty()) {
+      Task = std::move(Queue.Tasks.front());
+      Queue.Tasks.pop_front();
+      --QueuedTasks;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::runTask(PackagedTaskTy &Task) {
+#ifndef _MSC_VER
+  Task();
+#else
+  Task(/* unused */ false);
+#endif
+  // Notify the completion of the last task, in case someone waits on
+  // ThreadPool::wait(). Taking the lock guarantees the waiter either sees the
+  // new count or is already blocked when notified.
+  if (--UnfinishedTasks == 0) {
+    { std::unique_lock<std::mutex> LockGuard(CompletionLock); }
+    CompletionCondition.notify_all();
+  }
+}
+
+bool ThreadPool::runOneTask() {
+  unsigned QueueID =
+      (CurrentPool == this) ? CurrentQueue : NextQueue.load() % Queues.size();
+  PackagedTaskTy Task;
+  if (!pop(QueueID, Task))
+    return false;
+  runTask(Task);
+  return true;
+}
+
+void ThreadPool::TaskGroup::asyncImpl(std::function<void()> Task) {
+  ++PendingTasks;
+#ifndef _MSC_VER
+  Pool.push(PackagedTaskTy([this, Task] {
+    Task();
+    taskDone();
+  }));
+#else
+  Pool.push(PackagedTaskTy([this, Task](bool) -> bool {
+    Task();
+    taskDone();
+    return false;
+  }));
+#endif
+}
+
 #if LLVM_ENABLE_THREADS
 
 // Default to std::thread::hardware_concurrency
 ThreadPool::ThreadPool() : ThreadPool(std::thread::hardware_concurrency()) {}
 
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0), EnableFlag(true) {
-  // Create ThreadCount threads that will loop forever, wait on QueueCondition
-  // for tasks to be queued or the Pool to be destroyed.
+    : NextQueue(0), QueuedTasks(0), UnfinishedTasks(0), IdleThreads(0),
+      EnableFlag(true) {
+  // Always have a deque, even without threads, so that tasks can be queued.
+  Queues.reserve(ThreadCount ? ThreadCount : 1);
+  for (unsigned QueueID = 0; QueueID < (ThreadCount ? ThreadCount : 1);
+       ++QueueID)
+    Queues.push_back(llvm::make_unique<WorkerQueue>());
+
+  // Create ThreadCount threads that will loop forever, running the tasks of
+  // their deque or stealing from the others, and wait on QueueCondition when
+  // no task is available or the Pool is being destroyed.
   Threads.reserve(ThreadCount);
   for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
-    Threads.emplace_back([&] {
+    Threads.emplace_back([this, ThreadID] {
+      CurrentPool = this;
+      CurrentQueue = ThreadID;
       while (true) {
         PackagedTaskTy Task;
-        {
-          std::unique_lock<std::mutex> LockGuard(QueueLock);
-          // Wait for tasks to be pushed in the queue
-          QueueCondition.wait(LockGuard,
-                              [&] { return !EnableFlag || !Tasks.empty(); });
-          // Exit condition
-          if (!EnableFlag && Tasks.empty())
-            return;
-          // Yeah, we have a task, grab it and release the lock on the queue
-
-          // We first need to signal that we are active before popping the queue
-          // in order for wait() to properly detect that even if the queue is
-          // empty, there is still a task in flight.
-          {
-            ++ActiveThreads;
-            std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          }
-          Task = std::move(Tasks.front());
-          Tasks.pop();
+        if (pop(ThreadID, Task)) {
+          runTask(Task);
+          continue;
         }
-        // Run the task we just grabbed
-#ifndef _MSC_VER
-        Task();
-#else
-        Task(/* unused */ false);
-#endif
-
-        {
-          // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          --ActiveThreads;
-        }
-
-        // Notify task completion, in case someone waits on ThreadPool::wait()
-        CompletionCondition.notify_all();
+        std::unique_lock<std::mutex> LockGuard(QueueLock);
+        // Wait for tasks to be pushed in the queues
+        ++IdleThreads;
+        QueueCondition.wait(LockGuard,
+                            [&] { return !EnableFlag || QueuedTasks > 0; });
+        --IdleThreads;
+        // Exit condition
+        if (!EnableFlag && QueuedTasks <= 0)
+          return;
       }
     });
   }
 }
 
 void ThreadPool::wait() {
-  // Wait for all threads to complete and the queue to be empty
+  assert(CurrentPool != this &&
+         "ThreadPool::wait() called from a task, use a TaskGroup instead");
+  // Wait for all tasks to complete, which implies the queues are empty
   std::unique_lock<std::mutex> LockGuard(CompletionLock);
-  CompletionCondition.wait(LockGuard,
-                           [&] { return Tasks.empty() && !ActiveThreads; });
+  CompletionCondition.wait(LockGuard, [&] { return !UnfinishedTasks; });
 }
 
 std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
   /// Wrap the Task in a packaged_task to return a future object.
   PackagedTaskTy PackagedTask(std::move(Task));
   auto Future = PackagedTask.get_future();
-  {
-    // Lock the queue and push the new task
-    std::unique_lock<std::mutex> LockGuard(QueueLock);
 
-    // Don't allow enqueueing after disabling the pool
-    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+  // Don't allow enqueueing after disabling the pool
+  assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
 
-    Tasks.push(std::move(PackagedTask));
-  }
-  QueueCondition.notify_one();
+  push(std::move(PackagedTask));
   return Future.share();
 }
 
+void ThreadPool::TaskGroup::taskDone() {
+  // Wake up the threads waiting on the group: the threads of the pool sleep on
+  // its QueueCondition, as they also look for tasks to run, the others on its
+  // CompletionCondition. Once the count drops to zero a waiter may return and
+  // destroy the group, so don't touch it again.
+  ThreadPool &P = Pool;
+  if (--PendingTasks == 0) {
+    { std::unique_lock<std::mutex> LockGuard(P.QueueLock); }
+    P.QueueCondition.notify_all();
+    { std::unique_lock<std::mutex> LockGuard(P.CompletionLock); }
+    P.CompletionCondition.notify_all();
+  }
+}
+
+void ThreadPool::TaskGroup::wait() {
+  // A thread of the pool helps running the pending tasks, which include the
+  // tasks of the group that haven't been picked yet: blocking could starve the
+  // pool. Other threads just block, the pool makes progress without them.
+  // They don't wait on the QueueCondition, where they could take the wakeup
+  // meant for an idle thread of the pool.
+  if (CurrentPool != &Pool) {
+    std::unique_lock<std::mutex> LockGuard(Pool.CompletionLock);
+    Pool.CompletionCondition.wait(LockGuard, [&] { return !PendingTasks; });
+    return;
+  }
+  while (PendingTasks) {
+    if (Pool.runOneTask())
+      continue;
+    // Sleep until the tasks of the group complete or some new work shows up.
+    std::unique_lock<std::mutex> LockGuard(Pool.QueueLock);
+    ++Pool.IdleThreads;
+    Pool.QueueCondition.wait(LockGuard, [&] {
+      return !PendingTasks || Pool.QueuedTasks > 0;
+    });
+    --Pool.IdleThreads;
+  }
+}
+
 // The destructor joins all threads, waiting for completion.
 ThreadPool::~ThreadPool() {
+  // Running tasks may still submit children, let everything complete before
+  // disabling the pool.
+  wait();
   {
     std::unique_lock<std::mutex> LockGuard(QueueLock);
     EnableFlag = false;
@@ -113,7 +233,8 @@ ThreadPool::ThreadPool() : ThreadPool(0) {}
 
 // No threads are launched, issue a warning if ThreadCount is not 0
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0) {
+    : NextQueue(0), QueuedTasks(0), UnfinishedTasks(0), IdleThreads(0) {
+  Queues.push_back(llvm::make_unique<WorkerQueue>());
   if (ThreadCount) {
     errs() << "Warning: request a ThreadPool with " << ThreadCount
            << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
@@ -122,15 +243,8 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
 
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
-  while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
-    Tasks.pop();
-#ifndef _MSC_VER
-        Task();
-#else
-        Task(/* unused */ false);
-#endif
-  }
+  while (runOneTask())
+    ;
 }
 
 std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
@@ -144,10 +258,18 @@ std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
   auto Future = std::async(std::launch::deferred, std::move(Task), false).share();
   PackagedTaskTy PackagedTask([Future](bool) -> bool { Future.get(); return false; });
 #endif
-  Tasks.push(std::move(PackagedTask));
+  push(std::move(PackagedTask));
   return Future;
 }
 
+void ThreadPool::TaskGroup::taskDone() { --PendingTasks; }
+
+void ThreadPool::TaskGroup::wait() {
+  // Sequential implementation running the tasks until the group completes.
+  while (PendingTasks && Pool.runOneTask())
+    ;
+}
+
 ThreadPool::~ThreadPool() {
   wait();
 }
@@ -131,6 +131,8 @@ public:
 
   void relaxInstruction(const MCInst &Inst, MCInst &Res) const override;
 
+  bool allowsParallelRelaxation() const override { return true; }
+
   bool writeNopData(uint64_t Count, MCObjectWriter *OW) const override;
 };
 } // end anonymous namespace
@@ -0,0 +1,126 @@
+//===-- llvm/lib/Target/X86/X86CallLowering.cpp - Call lowering -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the lowering of LLVM calls to machine code calls for
+/// GlobalISel.
+///
+//===----------------------------------------------------------------------===//
+
+#include "X86CallLowering.h"
+#include "X86CallingConv.h"
+#include "X86ISelLowering.h"
+#include "X86InstrInfo.h"
+#include "X86Subtarget.h"
+#include "llvm/CodeGen/CallingConvLower.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+using namespace llvm;
+
+#include "X86GenCallingConv.inc"
+
+X86CallLowering::X86CallLowering(const X86TargetLowering &TLI)
+    : CallLowering(&TLI) {}
+
+/// Get the value type of \p Ty if the values of that type are passed and
+/// returned as is in a general purpose register, or an invalid type
+/// otherwise.
+static MVT getGPRValueType(const X86TargetLowering &TLI, const DataLayout &DL,
+                           Type *Ty) {
+  EVT VT = TLI.getValueType(DL, Ty, /*AllowUnknown=*/true);
+  // FIXME: The smaller integers are promoted by the calling convention, the
+  // values need an extension or a truncation then.
+  if (VT != MVT::i32 && VT != MVT::i64)
+    return MVT::INVALID_SIMPLE_VALUE_TYPE;
+  return VT.getSimpleVT();
+}
+
+bool X86CallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
+                                  const Value *Val, unsigned VReg) const {
+  assert(((Val && VReg) || (!Val && !VReg)) && "Return value without a vreg");
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = *MF.getFunction();
+  const X86Subtarget &STI = MF.getSubtarget<X86Subtarget>();
+  // FIXME: Only the x86-64 returns of nothing or of a value held in a single
+  // register are supported so far.
+  if (!STI.is64Bit() || F.isVarArg())
+    return false;
+
+  unsigned ResReg = 0;
+  if (Val) {
+    MVT VT = getGPRValueType(*getTLI<X86TargetLowering>(), MF.getDataLayout(),
+                             Val->getType());
+    if (VT == MVT::INVALID_SIMPLE_VALUE_TYPE)
+      return false;
+    SmallVector<CCValAssign, 1> RVLocs;
+    CCState CCInfo(F.getCallingConv(), F.isVarArg(), MF, RVLocs,
+                   F.getContext());
+    if (RetCC_X86(0, VT, VT, CCValAssign::Full, ISD::ArgFlagsTy(), CCInfo))
+      return false;
+    CCValAssign &VA = RVLocs[0];
+    if (!VA.isRegLoc() || VA.getLocInfo() != CCValAssign::Full)
+      return false;
+    ResReg = VA.getLocReg();
+    MIRBuilder.buildInstr(TargetOpcode::COPY, ResReg, VReg);
+  }
+
+  MachineInstr *Return = MIRBuilder.buildInstr(X86::RETQ);
+  if (ResReg)
+    MachineInstrBuilder(MF, Return).addReg(ResReg, RegState::Implicit);
+  return true;
+}
+
+bool X86CallLowering::lowerFormalArguments(
+    MachineIRBuilder &MIRBuilder, const Function::ArgumentListType &Args,
+    ArrayRef<unsigned> VRegs) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = *MF.getFunction();
+  const X86Subtarget &STI = MF.getSubtarget<X86Subtarget>();
+  // FIXME: Only the x86-64 arguments held in a single register are supported
+  // so far.
+  if (!STI.is64Bit() || F.isVarArg())
+    return false;
+
+  SmallVector<CCValAssign, 16> ArgLocs;
+  CCState CCInfo(F.getCallingConv(), F.isVarArg(), MF, ArgLocs,
+                 F.getContext());
+  const X86TargetLowering &TLI = *getTLI<X86TargetLowering>();
+  unsigned ArgNo = 0;
+  for (const Argument &Arg : Args) {
+    // The first argument is at index 1.
+    unsigned Idx = ArgNo + 1;
+    if (F.getAttributes().hasAttribute(Idx, Attribute::ByVal) ||
+        F.getAttributes().hasAttribute(Idx, Attribute::InReg) ||
+        F.getAttributes().hasAttribute(Idx, Attribute::StructRet) ||
+        F.getAttributes().hasAttribute(Idx, Attribute::Nest))
+      return false;
+    MVT VT = getGPRValueType(TLI, MF.getDataLayout(), Arg.getType());
+    if (VT == MVT::INVALID_SIMPLE_VALUE_TYPE)
+      return false;
+    if (CC_X86(ArgNo, VT, VT, CCValAssign::Full, ISD::ArgFlagsTy(), CCInfo))
+      return false;
+    ++ArgNo;
+  }
+  assert(ArgLocs.size() == VRegs.size() &&
+         "We have a different number of locations and args?!");
+  for (CCValAssign &VA : ArgLocs)
+    if (!VA.isRegLoc() || VA.getLocInfo() != CCValAssign::Full)
+      return false;
+
+  for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
+    CCValAssign &VA = ArgLocs[i];
+    // Transform the arguments in physical registers into virtual ones.
+    MIRBuilder.getMBB().addLiveIn(VA.getLocReg());
+    MIRBuilder.buildInstr(TargetOpcode::COPY, VRegs[i], VA.getLocReg());
+  }
+  return true;
+}
@@ -19,8 +19,10 @@
 #include "X86InstrInfo.h"
 #include "X86SelectionDAGInfo.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/CodeGen/GlobalISel/GISelAccessor.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
+#include <memory>
 #include <string>
 
 #define GET_SUBTARGETINFO_HEADER
@@ -298,6 +300,11 @@ private:
   X86TargetLowering TLInfo;
   X86FrameLowering FrameLowering;
 
+  /// Gather the accessor points to GlobalISel-related APIs.
+  /// This is used to avoid ifndefs spreading around while GISel is
+  /// an optional library.
+  std::unique_ptr<GISelAccessor> GISel;
+
 public:
   /// This constructor initializes the data members to match that
   /// of the specified triple.
@@ -319,6 +326,11 @@ public:
     return &getInstrInfo()->getRegisterInfo();
   }
 
+  /// This object will take ownership of \p GISelAccessor.
+  void setGISelAccessor(GISelAccessor &GISel) { this->GISel.reset(&GISel); }
+
+  const CallLowering *getCallLowering() const override;
+
   /// Returns the minimum alignment known to hold of the
   /// stack frame on entry to the function and which must be maintained by every
   /// function for this subtarget.
@@ -258,6 +258,19 @@ static void GetImportList(Module &DestModule,
   }
 }
 
+/// Walk through the functions defined in \p DestModule and collect the
+/// external calls that are candidates for import.
+static void findExternalCallsInModule(Module &DestModule,
+                                      const FunctionInfoIndex &Index,
+                                      StringSet<> &CalledFunctions,
+                                      SmallVector<StringRef, 64> &Worklist) {
+  for (auto &F : DestModule) {
+    if (F.isDeclaration() || F.hasFnAttribute(Attribute::OptimizeNone))
+      continue;
+    findExternalCalls(DestModule, F, Index, CalledFunctions, Worklist);
+  }
+}
+
 // Automatically import functions in Module \p DestModule based on the summaries
 // index.
 //
@@ -271,11 +284,7 @@ bool FunctionImporter::importFunctions(Module &DestModule) {
   /// First step is collecting the called external functions.
   StringSet<> CalledFunctions;
   SmallVector<StringRef, 64> Worklist;
-  for (auto &F : DestModule) {
-    if (F.isDeclaration() || F.hasFnAttribute(Attribute::OptimizeNone))
-      continue;
-    findExternalCalls(DestModule, F, Index, CalledFunctions, Worklist);
-  }
+  findExternalCallsInModule(DestModule, Index, CalledFunctions, Worklist);
   if (Worklist.empty())
     return false;
 
@@ -322,6 +331,30 @@ bool FunctionImporter::importFunctions(Module &DestModule) {
   return ImportedCount;
 }
 
+// Compute the functions that would be imported in Module \p DestModule, based
+// on the summaries index. The source modules are loaded lazily and only the
+// functions considered for import are materialized.
+void FunctionImporter::computeImportList(Module &DestModule,
+                                         ImportMapTy &ImportList) {
+  StringSet<> CalledFunctions;
+  SmallVector<StringRef, 64> Worklist;
+  findExternalCallsInModule(DestModule, Index, CalledFunctions, Worklist);
+  if (Worklist.empty())
+    return;
+
+  std::map<StringRef, DenseSet<const GlobalValue *>>
+      ModuleToFunctionsToImportMap;
+  ModuleLazyLoaderCache ModuleLoaderCache(ModuleLoader);
+  GetImportList(DestModule, Worklist, CalledFunctions,
+                ModuleToFunctionsToImportMap, Index, ModuleLoaderCache);
+
+  for (auto &FunctionsToImportPerModule : ModuleToFunctionsToImportMap) {
+    auto &Entry = ImportList[FunctionsToImportPerModule.first];
+    for (const GlobalValue *GV : FunctionsToImportPerModule.second)
+      Entry.insert(GV->getName());
+  }
+}
+
 /// Summary file to use for function importing when using -function-import from
 /// the command line.
 static cl::opt<std::string>
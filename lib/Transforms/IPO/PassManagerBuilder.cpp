@@ -571,7 +571,10 @@ void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM) {
   // If we didn't decide to inline a function, check to see if we can
   // transform it to pass arguments by value instead of by reference.
   PM.add(createArgumentPromotionPass());
+}
 
+void PassManagerBuilder::addLTOScalarOptimizationPasses(
+    legacy::PassManagerBase &PM) {
   // The IPO passes may leave cruft around.  Clean up after them.
   PM.add(createInstructionCombiningPass());
   addExtensionsToPM(EP_Peephole, PM);
@@ -661,9 +664,47 @@ void PassManagerBuilder::populateLTOPassManager(legacy::PassManagerBase &PM) {
   if (VerifyInput)
     PM.add(createVerifierPass());
 
+  if (OptLevel > 1) {
+    addLTOOptimizationPasses(PM);
+    addLTOScalarOptimizationPasses(PM);
+  }
+
+  addLTOFinalPasses(PM);
+}
+
+void PassManagerBuilder::populateLTOInterproceduralPassManager(
+    legacy::PassManagerBase &PM) {
+  if (LibraryInfo)
+    PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+  if (VerifyInput)
+    PM.add(createVerifierPass());
+
   if (OptLevel > 1)
     addLTOOptimizationPasses(PM);
+}
+
+void PassManagerBuilder::populateLTOScalarPassManager(
+    legacy::PassManagerBase &PM) {
+  if (LibraryInfo)
+    PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+  if (OptLevel > 1) {
+    // Provide AliasAnalysis services for optimizations.
+    addInitialAliasAnalysisPasses(PM);
+    addLTOScalarOptimizationPasses(PM);
+  }
+}
+
+void PassManagerBuilder::populateLTOFinalPassManager(
+    legacy::PassManagerBase &PM) {
+  if (LibraryInfo)
+    PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+  addLTOFinalPasses(PM);
+}
 
+void PassManagerBuilder::addLTOFinalPasses(legacy::PassManagerBase &PM) {
   // Create a function that performs CFI checks for cross-DSO calls with targets
   // in the current module.
   PM.add(createCrossDSOCFIPass());
@@ -3069,10 +3069,11 @@ PreservedAnalyses InstCombinePass::run(Function &F,
     // No changes, all analyses are preserved.
     return PreservedAnalyses::all();
 
-  // Mark all the analyses that instcombine updates as preserved.
-  // FIXME: Need a way to preserve CFG analyses here!
+  // Mark all the analyses that instcombine updates as preserved. It doesn't
+  // change the CFG, so the loop info stays valid as well.
   PreservedAnalyses PA;
   PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<LoopAnalysis>();
   return PA;
 }
 
@@ -10,8 +10,8 @@
 // This file implements a trivial dead store elimination that only considers
 // basic-block local redundant stores.
 //
-// FIXME: This should eventually be extended to be a post-dominator tree
-// traversal.  Doing so would be pretty trivial.
+// With -enable-dse-memssa, it then walks MemorySSA to also remove the stores
+// that are dead across basic blocks.
 //
 //===----------------------------------------------------------------------===//
 
@@ -33,10 +33,13 @@
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
 using namespace llvm;
 
 #define DEBUG_TYPE "dse"
@@ -44,6 +47,18 @@ using namespace llvm;
 STATISTIC(NumRedundantStores, "Number of redundant stores deleted");
 STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther , "Number of other instrs removed");
+STATISTIC(NumGlobalStores, "Number of stores deleted across blocks");
+
+static cl::opt<bool>
+EnableMemorySSA("enable-dse-memssa", cl::init(false), cl::Hidden,
+                cl::desc("Use MemorySSA to remove dead stores across blocks"));
+
+// The number of memory accesses and blocks visited after a store to prove that
+// it is dead. This keeps the MemorySSA walk linear in the size of the function.
+static cl::opt<unsigned>
+MemorySSAScanLimit("dse-memssa-scan-limit", cl::init(150), cl::Hidden,
+                   cl::desc("The number of memory accesses and blocks to scan "
+                            "after a store with MemorySSA (default = 150)"));
 
 namespace {
   struct DSE : public FunctionPass {
@@ -73,6 +88,9 @@ namespace {
         if (DT->isReachableFromEntry(&I))
           Changed |= runOnBasicBlock(I);
 
+      if (EnableMemorySSA)
+        Changed |= eliminateDeadStoresWithMemorySSA(F);
+
       AA = nullptr; MD = nullptr; DT = nullptr;
       return Changed;
     }
@@ -81,6 +99,9 @@ namespace {
     bool MemoryIsNotModifiedBetween(Instruction *FirstI, Instruction *SecondI);
     bool HandleFree(CallInst *F);
     bool handleEndBlock(BasicBlock &BB);
+    bool eliminateDeadStoresWithMemorySSA(Function &F);
+    bool isDeadStore(Instruction *I, MemoryDef *Def, const MemoryLocation &Loc,
+                     MemorySSA &MSSA);
     void RemoveAccessedObjects(const MemoryLocation &LoadedLoc,
                                SmallSetVector<Value *, 16> &DeadStackObjects,
                                const DataLayout &DL);
@@ -959,3 +980,151 @@ void DSE::RemoveAccessedObjects(const MemoryLocation &LoadedLoc,
     return !AA->isNoAlias(StackLoc, LoadedLoc);
   });
 }
+
+/// isDeadAtFunctionEnd - Return true if the object is dead when the function
+/// returns, like the objects handleEndBlock removes the stores to.
+static bool isDeadAtFunctionEnd(const Value *Object,
+                                const TargetLibraryInfo *TLI) {
+  if (isa<AllocaInst>(Object))
+    return true;
+  if (const Argument *A = dyn_cast<Argument>(Object))
+    return A->hasByValOrInAllocaAttr();
+  return isAllocLikeFn(Object, TLI) &&
+         !PointerMayBeCaptured(Object, true, true);
+}
+
+/// isGuaranteedLoopInvariant - Return true if \p Ptr has the same value every
+/// time it is evaluated, so alias queries against it stay valid across the
+/// back-edges of any cycle. Only pointers computed in the entry block, or at a
+/// constant offset from one, are known to be; this doesn't need LoopInfo.
+static bool isGuaranteedLoopInvariant(const Value *Ptr) {
+  Ptr = Ptr->stripPointerCasts();
+  if (auto *GEP = dyn_cast<GEPOperator>(Ptr))
+    if (GEP->hasAllConstantIndices())
+      Ptr = GEP->getPointerOperand()->stripPointerCasts();
+  if (auto *I = dyn_cast<Instruction>(Ptr))
+    return I->getParent() == &I->getFunction()->getEntryBlock();
+  return true;
+}
+
+/// isDeadStore - Return true if the location written by \p I is never read
+/// before being completely overwritten on every path, or before the function
+/// returns if it's local to the function.
+///
+/// MemorySSA chains every access to the ones that may observe it: walk the
+/// accesses from \p Def forward, until they read the location or completely
+/// overwrite it. If none reads it, look for a path from \p I to the exit of
+/// the function that doesn't go through one of the overwriting blocks.
+///
+/// A MemoryPhi may join the paths around a loop back-edge, where the pointer
+/// of the store may name another location than it did in the iteration the
+/// walk started from. Alias queries can't tell the iterations apart, so only
+/// walk past MemoryPhis when the location is loop invariant.
+bool DSE::isDeadStore(Instruction *I, MemoryDef *Def, const MemoryLocation &Loc,
+                      MemorySSA &MSSA) {
+  const DataLayout &DL = I->getModule()->getDataLayout();
+  BasicBlock *BB = I->getParent();
+  unsigned Scanned = 0;
+
+  // Blocks which kill the location when entered from their top, and whether it
+  // is killed after I in its own block.
+  SmallPtrSet<BasicBlock *, 8> KillingBlocks;
+  bool KilledInBlock = false;
+  bool LocIsInvariant = isGuaranteedLoopInvariant(Loc.Ptr);
+
+  SmallVector<MemoryAccess *, 16> WorkList;
+  SmallPtrSet<MemoryAccess *, 16> Visited;
+  for (User *U : Def->users())
+    WorkList.push_back(cast<MemoryAccess>(U));
+  while (!WorkList.empty()) {
+    MemoryAccess *MA = WorkList.pop_back_val();
+    if (!Visited.insert(MA).second)
+      continue;
+    if (++Scanned > MemorySSAScanLimit)
+      return false;
+    if (isa<MemoryPhi>(MA) && !LocIsInvariant)
+      return false;
+
+    if (auto *UseOrDef = dyn_cast<MemoryUseOrDef>(MA)) {
+      Instruction *UseInst = UseOrDef->getMemoryInst();
+      if (AA->getModRefInfo(UseInst, Loc) & MRI_Ref)
+        return false;
+      if (isa<MemoryUse>(MA))
+        continue;
+
+      // A write that completely overwrites the location ends this path.
+      MemoryLocation UseLoc = getLocForWrite(UseInst, *AA);
+      int64_t InstWriteOffset, DepWriteOffset;
+      if (UseLoc.Ptr && (UseInst == I ||
+                         isOverwrite(UseLoc, Loc, DL, *TLI, DepWriteOffset,
+                                     InstWriteOffset) == OverwriteComplete)) {
+        if (UseInst->getParent() == BB && UseInst != I &&
+            MSSA.locallyDominates(Def, MA))
+          KilledInBlock = true;
+        else
+          KillingBlocks.insert(UseInst->getParent());
+        continue;
+      }
+    }
+
+    for (User *U : MA->users())
+      WorkList.push_back(cast<MemoryAccess>(U));
+  }
+
+  // Nothing reads the location again before it is overwritten. This is enough
+  // for objects that die with the function.
+  if (KilledInBlock ||
+      isDeadAtFunctionEnd(GetUnderlyingObject(Loc.Ptr, DL), TLI))
+    return true;
+
+  if (BB->getTerminator()->getNumSuccessors() == 0)
+    return false;
+  SmallVector<BasicBlock *, 16> Blocks(succ_begin(BB), succ_end(BB));
+  SmallPtrSet<BasicBlock *, 16> VisitedBlocks;
+  while (!Blocks.empty()) {
+    BasicBlock *Succ = Blocks.pop_back_val();
+    if (KillingBlocks.count(Succ) || !VisitedBlocks.insert(Succ).second)
+      continue;
+    if (++Scanned > MemorySSAScanLimit)
+      return false;
+    // The function returns without overwriting the location.
+    if (Succ->getTerminator()->getNumSuccessors() == 0)
+      return false;
+    Blocks.append(succ_begin(Succ), succ_end(Succ));
+  }
+  return true;
+}
+
+/// eliminateDeadStoresWithMemorySSA - Remove the stores which are dead across
+/// basic blocks, see isDeadStore.
+bool DSE::eliminateDeadStoresWithMemorySSA(Function &F) {
+  MemorySSA MSSA(F);
+  std::unique_ptr<MemorySSAWalker> Walker(MSSA.buildMemorySSA(AA, DT));
+
+  // MemorySSA isn't updated as instructions are deleted: find all the dead
+  // stores first. Deleting a store only removes the reads it performs, so the
+  // other stores found dead remain dead.
+  SmallVector<Instruction *, 16> DeadStores;
+  for (BasicBlock &BB : F) {
+    if (!DT->isReachableFromEntry(&BB))
+      continue;
+    for (Instruction &I : BB) {
+      if (!hasMemoryWrite(&I, *TLI) || !isRemovable(&I))
+        continue;
+      MemoryLocation Loc = getLocForWrite(&I, *AA);
+      if (!Loc.Ptr)
+        continue;
+      auto *Def = dyn_cast_or_null<MemoryDef>(MSSA.getMemoryAccess(&I));
+      if (Def && isDeadStore(&I, Def, Loc, MSSA))
+        DeadStores.push_back(&I);
+    }
+  }
+
+  for (Instruction *Dead : DeadStores) {
+    DEBUG(dbgs() << "DSE: Remove Dead Store Across Blocks:\n  DEAD: " << *Dead
+                 << '\n');
+    DeleteDeadInstruction(Dead, *MD, *TLI);
+    ++NumGlobalStores;
+  }
+  return !DeadStores.empty();
+}
@@ -50,6 +50,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/MemorySSA.h"
 #include "llvm/Transforms/Utils/SSAUpdater.h"
 #include <vector>
 using namespace llvm;
@@ -69,6 +70,12 @@ static cl::opt<bool> EnablePRE("enable-pre",
                                cl::init(true), cl::Hidden);
 static cl::opt<bool> EnableLoadPRE("enable-load-pre", cl::init(true));
 
+// Answer the clobber queries of loads and read-only calls from MemorySSA, and
+// don't use MemoryDependenceAnalysis at all. Load PRE is not performed then.
+static cl::opt<bool> EnableMemorySSA(
+    "enable-gvn-memssa", cl::init(false), cl::Hidden,
+    cl::desc("Use MemorySSA instead of MemoryDependenceAnalysis in GVN"));
+
 // Maximum allowed recursion depth.
 static cl::opt<uint32_t>
 MaxRecurseDepth("max-recurse-depth", cl::Hidden, cl::init(1000), cl::ZeroOrMore,
@@ -111,8 +118,11 @@ namespace {
   class ValueTable {
     DenseMap<Value*, uint32_t> valueNumbering;
     DenseMap<Expression, uint32_t> expressionNumbering;
+    DenseMap<const MemoryAccess*, uint32_t> memoryNumbering;
     AliasAnalysis *AA;
     MemoryDependenceAnalysis *MD;
+    MemorySSA *MSSA;
+    MemorySSAWalker *MSSAWalker;
     DominatorTree *DT;
 
     uint32_t nextValueNumber;
@@ -123,8 +133,10 @@ namespace {
                                      Value *LHS, Value *RHS);
     Expression create_extractvalue_expression(ExtractValueInst* EI);
     uint32_t lookup_or_add_call(CallInst* C);
+    uint32_t lookup_or_add_load(LoadInst* L);
+    uint32_t lookup_or_add_memory_state(Instruction* I);
   public:
-    ValueTable() : nextValueNumber(1) { }
+    ValueTable() : MSSA(nullptr), MSSAWalker(nullptr), nextValueNumber(1) { }
     uint32_t lookup_or_add(Value *V);
     uint32_t lookup(Value *V) const;
     uint32_t lookup_or_add_cmp(unsigned Opcode, CmpInst::Predicate Pred,
@@ -136,6 +148,10 @@ namespace {
     void setAliasAnalysis(AliasAnalysis* A) { AA = A; }
     AliasAnalysis *getAliasAnalysis() const { return AA; }
     void setMemDep(MemoryDependenceAnalysis* M) { MD = M; }
+    void setMemorySSA(MemorySSA *M, MemorySSAWalker *W) {
+      MSSA = M;
+      MSSAWalker = W;
+    }
     void setDomTree(DominatorTree* D) { DT = D; }
     uint32_t getNextUnusedValueNumber() { return nextValueNumber; }
     void verifyRemoved(const Value *) const;
@@ -290,6 +306,20 @@ uint32_t ValueTable::lookup_or_add_call(CallInst *C) {
     return e;
   } else if (AA->onlyReadsMemory(C)) {
     Expression exp = create_expression(C);
+    if (MSSAWalker) {
+      // Calls reading the same memory state compute the same value.
+      uint32_t MemNum = lookup_or_add_memory_state(C);
+      if (!MemNum) {
+        valueNumbering[C] = nextValueNumber;
+        return nextValueNumber++;
+      }
+      exp.varargs.push_back(MemNum);
+      uint32_t &e = expressionNumbering[exp];
+      if (!e) e = nextValueNumber++;
+      valueNumbering[C] = e;
+      return e;
+    }
+
     uint32_t &e = expressionNumbering[exp];
     if (!e) {
       e = nextValueNumber++;
@@ -390,6 +420,42 @@ uint32_t ValueTable::lookup_or_add_call(CallInst *C) {
   }
 }
 
+/// Returns the value number of the memory state the specified instruction
+/// reads, that is of its clobbering MemorySSA access. Returns 0 if the
+/// instruction isn't known to MemorySSA.
+uint32_t ValueTable::lookup_or_add_memory_state(Instruction *I) {
+  if (!MSSA->getMemoryAccess(I))
+    return 0;
+
+  MemoryAccess *Clobber = MSSAWalker->getClobberingMemoryAccess(I);
+  uint32_t &e = memoryNumbering[Clobber];
+  if (!e) e = nextValueNumber++;
+  return e;
+}
+
+/// Loads are only numbered by their memory state when MemorySSA is available:
+/// two simple loads of the same type, from pointers with the same value number
+/// and with the same clobbering access, load the same value.
+uint32_t ValueTable::lookup_or_add_load(LoadInst *L) {
+  uint32_t MemNum =
+      (MSSAWalker && L->isSimple()) ? lookup_or_add_memory_state(L) : 0;
+  if (!MemNum) {
+    valueNumbering[L] = nextValueNumber;
+    return nextValueNumber++;
+  }
+
+  Expression exp;
+  exp.type = L->getType();
+  exp.opcode = L->getOpcode();
+  exp.varargs.push_back(lookup_or_add(L->getPointerOperand()));
+  exp.varargs.push_back(MemNum);
+
+  uint32_t &e = expressionNumbering[exp];
+  if (!e) e = nextValueNumber++;
+  valueNumbering[L] = e;
+  return e;
+}
+
 /// Returns true if a value number exists for the specified value.
 bool ValueTable::exists(Value *V) const { return valueNumbering.count(V) != 0; }
 
@@ -453,6 +519,8 @@ uint32_t ValueTable::lookup_or_add(Value *V) {
     case Instruction::ExtractValue:
       exp = create_extractvalue_expression(cast<ExtractValueInst>(I));
       break;
+    case Instruction::Load:
+      return lookup_or_add_load(cast<LoadInst>(I));
     default:
       valueNumbering[V] = nextValueNumber;
       return nextValueNumber++;
@@ -489,6 +557,7 @@ uint32_t ValueTable::lookup_or_add_cmp(unsigned Opcode,
 void ValueTable::clear() {
   valueNumbering.clear();
   expressionNumbering.clear();
+  memoryNumbering.clear();
   nextValueNumber = 1;
 }
 
@@ -634,6 +703,8 @@ namespace {
   class GVN : public FunctionPass {
     bool NoLoads;
     MemoryDependenceAnalysis *MD;
+    std::unique_ptr<MemorySSA> MSSA;
+    std::unique_ptr<MemorySSAWalker> MSSAWalker;
     DominatorTree *DT;
     const TargetLibraryInfo *TLI;
     AssumptionCache *AC;
@@ -734,7 +805,7 @@ namespace {
       AU.addRequired<AssumptionCacheTracker>();
       AU.addRequired<DominatorTreeWrapperPass>();
       AU.addRequired<TargetLibraryInfoWrapperPass>();
-      if (!NoLoads)
+      if (!NoLoads && !EnableMemorySSA)
         AU.addRequired<MemoryDependenceAnalysis>();
       AU.addRequired<AAResultsWrapperPass>();
 
@@ -745,6 +816,7 @@ namespace {
 
     // Helper functions of redundant load elimination
     bool processLoad(LoadInst *L);
+    bool processLoadFromMemorySSA(LoadInst *L);
     bool processNonLocalLoad(LoadInst *L);
     bool processAssumeIntrinsic(IntrinsicInst *II);
     void AnalyzeLoadAvailability(LoadInst *LI, LoadDepVect &Deps, 
@@ -758,6 +830,8 @@ namespace {
     bool processBlock(BasicBlock *BB);
     void dump(DenseMap<uint32_t, Value*> &d);
     bool iterateOnFunction(Function &F);
+    void buildMemorySSA(Function &F);
+    void releaseMemorySSA();
     bool performPRE(Function &F);
     bool performScalarPRE(Instruction *I);
     bool performScalarPREInsertion(Instruction *Instr, BasicBlock *Pred,
@@ -1925,7 +1999,7 @@ static void patchAndReplaceAllUsesWith(Instruction *I, Value *Repl) {
 /// Attempt to eliminate a load, first by eliminating it
 /// locally, and then attempting non-local elimination if that fails.
 bool GVN::processLoad(LoadInst *L) {
-  if (!MD)
+  if (!MD && !MSSAWalker)
     return false;
 
   if (!L->isSimple())
@@ -1936,6 +2010,9 @@ bool GVN::processLoad(LoadInst *L) {
     return true;
   }
 
+  if (MSSAWalker)
+    return processLoadFromMemorySSA(L);
+
   // ... to a pointer that has been loaded from before...
   MemDepResult Dep = MD->getDependency(L);
   const DataLayout &DL = L->getModule()->getDataLayout();
@@ -2097,6 +2174,45 @@ bool GVN::processLoad(LoadInst *L) {
   return false;
 }
 
+/// Attempt to eliminate a load by forwarding the value written by its
+/// clobbering store or memory intrinsic, as found by the MemorySSA walker.
+/// Loads made redundant by other loads are found by value numbering.
+bool GVN::processLoadFromMemorySSA(LoadInst *L) {
+  if (!MSSA->getMemoryAccess(L))
+    return false;
+
+  MemoryAccess *Clobber = MSSAWalker->getClobberingMemoryAccess(L);
+  MemoryDef *Def = dyn_cast<MemoryDef>(Clobber);
+  if (!Def || MSSA->isLiveOnEntryDef(Def))
+    return false;
+
+  Instruction *DepInst = Def->getMemoryInst();
+  const DataLayout &DL = L->getModule()->getDataLayout();
+  Value *AvailVal = nullptr;
+  if (StoreInst *DepSI = dyn_cast<StoreInst>(DepInst)) {
+    int Offset = AnalyzeLoadFromClobberingStore(
+        L->getType(), L->getPointerOperand(), DepSI);
+    if (Offset != -1)
+      AvailVal = GetStoreValueForLoad(DepSI->getValueOperand(), Offset,
+                                      L->getType(), L, DL);
+  } else if (MemIntrinsic *DepMI = dyn_cast<MemIntrinsic>(DepInst)) {
+    int Offset = AnalyzeLoadFromClobberingMemInst(
+        L->getType(), L->getPointerOperand(), DepMI, DL);
+    if (Offset != -1)
+      AvailVal = GetMemInstValueForLoad(DepMI, Offset, L->getType(), L, DL);
+  }
+
+  if (!AvailVal)
+    return false;
+
+  DEBUG(dbgs() << "GVN MEMSSA FORWARDED:\n" << *DepInst << '\n'
+               << *AvailVal << '\n' << *L << "\n\n\n");
+  L->replaceAllUsesWith(AvailVal);
+  markInstructionForDeletion(L);
+  ++NumGVNLoad;
+  return true;
+}
+
 // In order to find a leader for a given value number at a
 // specific basic block, we first obtain the list of all Values for that number,
 // and then scan the list to find one whose block dominates the block in
@@ -2351,9 +2467,13 @@ bool GVN::processInstruction(Instruction *I) {
     if (processLoad(LI))
       return true;
 
-    unsigned Num = VN.lookup_or_add(LI);
-    addToLeaderTable(Num, LI, LI->getParent());
-    return false;
+    // With MemorySSA, loads are numbered by the memory state they read: look
+    // for a dominating load with the same number like for other expressions.
+    if (!MSSAWalker) {
+      unsigned Num = VN.lookup_or_add(LI);
+      addToLeaderTable(Num, LI, LI->getParent());
+      return false;
+    }
   }
 
   // For conditional branches, we can perform simple conditional propagation on
@@ -2458,8 +2578,10 @@ bool GVN::runOnFunction(Function& F) {
   if (skipOptnoneFunction(F))
     return false;
 
-  if (!NoLoads)
+  if (!NoLoads && !EnableMemorySSA)
     MD = &getAnalysis<MemoryDependenceAnalysis>();
+  else
+    MD = nullptr;
   DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
   AC = &getAnalysis<AssumptionCacheTracker>().getAssumptionCache(F);
   TLI = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
@@ -2792,6 +2914,8 @@ bool GVN::splitCriticalEdges() {
 /// Executes one iteration of GVN
 bool GVN::iterateOnFunction(Function &F) {
   cleanupGlobalSets();
+  if (!NoLoads && EnableMemorySSA)
+    buildMemorySSA(F);
 
   // Top-down walk of the dominator tree
   bool Changed = false;
@@ -2811,9 +2935,26 @@ bool GVN::iterateOnFunction(Function &F) {
        I != E; I++)
     Changed |= processBlock(*I);
 
+  releaseMemorySSA();
   return Changed;
 }
 
+/// GVN doesn't update MemorySSA as it changes the function: build it for every
+/// iteration. Within an iteration, GVN only deletes memory instructions and
+/// doesn't create any new load or call, so the clobbers found by the walker
+/// remain correct for the instructions left.
+void GVN::buildMemorySSA(Function &F) {
+  MSSA = make_unique<MemorySSA>(F);
+  MSSAWalker.reset(MSSA->buildMemorySSA(VN.getAliasAnalysis(), DT));
+  VN.setMemorySSA(MSSA.get(), MSSAWalker.get());
+}
+
+void GVN::releaseMemorySSA() {
+  VN.setMemorySSA(nullptr, nullptr);
+  MSSAWalker.reset();
+  MSSA.reset();
+}
+
 void GVN::cleanupGlobalSets() {
   VN.clear();
   LeaderTable.clear();
@@ -14,8 +14,10 @@
 #include "llvm/Transforms/Scalar/LowerExpectIntrinsic.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Intrinsics.h"
@@ -159,10 +161,14 @@ static bool lowerExpectIntrinsic(Function &F) {
 }
 
 PreservedAnalyses LowerExpectIntrinsicPass::run(Function &F) {
-  if (lowerExpectIntrinsic(F))
-    return PreservedAnalyses::none();
-
-  return PreservedAnalyses::all();
+  if (!lowerExpectIntrinsic(F))
+    return PreservedAnalyses::all();
+
+  // Only branch weights and intrinsic calls change, not the CFG.
+  PreservedAnalyses PA;
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<LoopAnalysis>();
+  return PA;
 }
 
 namespace {
@@ -0,0 +1,63 @@
+; RUN: llc -mtriple=x86_64-linux-gnu -O0 -global-isel -stop-after=irtranslator -o /dev/null %s | FileCheck %s
+; REQUIRES: global-isel
+; This file checks that the translation from llvm IR to generic MachineInstr
+; is correct.
+
+; Tests for add.
+; CHECK: name: addi64
+; CHECK: registers:
+; CHECK-NEXT: - { id: 0, class: _ }
+; CHECK-NEXT: - { id: 1, class: _ }
+; CHECK-NEXT: - { id: 2, class: _ }
+; CHECK: liveins: %rdi, %rsi
+; CHECK: [[ARG1:%[0-9]+]] = COPY %rdi
+; CHECK-NEXT: [[ARG2:%[0-9]+]] = COPY %rsi
+; CHECK-NEXT: [[RES:%[0-9]+]] = G_ADD [[ARG1]], [[ARG2]]
+; CHECK-NEXT: %rax = COPY [[RES]]
+; CHECK-NEXT: RETQ implicit %rax
+define i64 @addi64(i64 %arg1, i64 %arg2) {
+  %res = add i64 %arg1, %arg2
+  ret i64 %res
+}
+
+; Tests for sub, and, or and xor.
+; CHECK: name: bitops32
+; CHECK: liveins: %edi, %esi
+; CHECK: [[ARG1:%[0-9]+]] = COPY %edi
+; CHECK-NEXT: [[ARG2:%[0-9]+]] = COPY %esi
+; CHECK-NEXT: [[SUB:%[0-9]+]] = G_SUB [[ARG1]], [[ARG2]]
+; CHECK-NEXT: [[AND:%[0-9]+]] = G_AND [[SUB]], [[ARG2]]
+; CHECK-NEXT: [[OR:%[0-9]+]] = G_OR [[AND]], [[ARG1]]
+; CHECK-NEXT: [[XOR:%[0-9]+]] = G_XOR [[OR]], [[SUB]]
+; CHECK-NEXT: %eax = COPY [[XOR]]
+; CHECK-NEXT: RETQ implicit %eax
+define i32 @bitops32(i32 %arg1, i32 %arg2) {
+  %sub = sub i32 %arg1, %arg2
+  %and = and i32 %sub, %arg2
+  %or = or i32 %and, %arg1
+  %xor = xor i32 %or, %sub
+  ret i32 %xor
+}
+
+; Tests for br.
+; CHECK: name: uncondbr
+; CHECK: body:
+;
+; Entry basic block.
+; CHECK: {{[0-9a-zA-Z._-]+}}:
+;
+; Make sure we have one successor and only one.
+; CHECK-NEXT: successors: %[[END:[0-9a-zA-Z._-]+]](0x80000000 / 0x80000000 = 100.00%)
+;
+; Check that we emit the correct branch.
+; CHECK: G_BR %[[END]]
+;
+; Check that end contains the return instruction.
+; CHECK: [[END]]:
+; CHECK-NEXT: RETQ
+define void @uncondbr() {
+entry:
+  br label %end
+end:
+  ret void
+}
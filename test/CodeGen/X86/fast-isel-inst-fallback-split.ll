@@ -0,0 +1,22 @@
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-linux-gnu -fast-isel-inst-fallback \
+; RUN:     -verify-machineinstrs -o /dev/null
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-linux-gnu -fast-isel-inst-fallback \
+; RUN:     -fast-isel-verbose -o /dev/null 2>&1 | FileCheck %s
+
+; The i512 store uses values SelectionDAG splits across several registers,
+; where FastISel would have put them in one: it can't be selected on its own,
+; so the rest of the block goes to SelectionDAG.
+
+; CHECK: FastISel miss: store i512
+; CHECK-NOT: FastISel miss
+
+define i32 @foo() {
+bb:
+  %tmp44.i = fsub <4 x float> <float -0.000000e+00, float -0.000000e+00, float -0.000000e+00, float -0.000000e+00>, <float 0.000000e+00, float 0.000000e+00, float 1.000000e+00, float 0.000000e+00>
+  %0 = bitcast <4 x float> %tmp44.i to i128
+  %1 = zext i128 %0 to i512
+  %2 = shl nuw nsw i512 %1, 256
+  %ins = or i512 %2, 3325764857622480139933400731976840738652108318779753826115024029985671937147149347761402413803120180680770390816681124225944317364750115981129923635970048
+  store i512 %ins, i512* undef, align 64
+  ret i32 0
+}
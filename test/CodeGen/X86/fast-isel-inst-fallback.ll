@@ -0,0 +1,31 @@
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-unknown -fast-isel-verbose \
+; RUN:     -fast-isel-inst-fallback -o /dev/null 2>&1 | FileCheck %s
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-unknown -fast-isel-verbose \
+; RUN:     -o /dev/null 2>&1 | FileCheck %s --check-prefix=BLOCK
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-unknown -fast-isel-inst-fallback \
+; RUN:     | FileCheck %s --check-prefix=ASM
+
+; FastISel doesn't select shufflevector. With -fast-isel-inst-fallback, only
+; the shuffles go through SelectionDAG, and FastISel resumes with the store
+; in between. Otherwise the rest of the block is given to SelectionDAG on the
+; first miss.
+
+; CHECK: FastISel miss: %s2 = shufflevector
+; CHECK-NEXT: FastISel miss: %s = shufflevector
+; CHECK-NOT: FastISel miss
+
+; BLOCK: FastISel miss: %s2 = shufflevector
+; BLOCK-NOT: FastISel miss
+
+; ASM-LABEL: f:
+; ASM: pshufd $27
+; ASM: pshufd $177
+; ASM: retq
+define void @f(<4 x i32>* %p, <4 x i32>* %q) {
+  %a = load <4 x i32>, <4 x i32>* %p, align 16
+  %s = shufflevector <4 x i32> %a, <4 x i32> undef, <4 x i32> <i32 3, i32 2, i32 1, i32 0>
+  store <4 x i32> %s, <4 x i32>* %q, align 16
+  %s2 = shufflevector <4 x i32> %s, <4 x i32> undef, <4 x i32> <i32 1, i32 0, i32 3, i32 2>
+  store <4 x i32> %s2, <4 x i32>* %p, align 16
+  ret void
+}
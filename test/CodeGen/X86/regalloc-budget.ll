@@ -0,0 +1,35 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -regalloc-budget-intervals=1 \
+; RUN:     -pass-remarks-analysis=regalloc 2>&1 | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -regalloc-budget-intervals=1000 \
+; RUN:     -pass-remarks-analysis=regalloc 2>&1 | FileCheck %s --check-prefix=FULL
+
+; Once a function has more virtual registers than the budget allows, the
+; greedy allocator stops splitting global live ranges, says so through a
+; remark, and still allocates the function.
+
+; CHECK: remark: <unknown>:0:0: greedy register allocation over budget ({{[0-9]+}} virtual registers): spilling global live ranges instead of splitting them
+; CHECK-LABEL: sum:
+; CHECK: retq
+
+; FULL-NOT: remark:
+; FULL-LABEL: sum:
+; FULL: retq
+define i64 @sum(i64* %p, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %addr = getelementptr inbounds i64, i64* %p, i64 %i
+  %v = load i64, i64* %addr, align 8
+  %acc.next = add i64 %acc, %v
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  ret i64 %r
+}
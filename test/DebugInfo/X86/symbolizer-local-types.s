@@ -0,0 +1,127 @@
+# RUN: llvm-mc -triple x86_64-pc-linux -filetype=obj %s -o %t.o
+# RUN: llvm-mc -triple x86_64-pc-linux -filetype=obj -defsym ARANGES=1 %s \
+# RUN:   -o %t.aranges.o
+# RUN: echo "0x1004" > %t.input
+# RUN: echo "0x1014" >> %t.input
+# RUN: echo "0x1024" >> %t.input
+# RUN: llvm-symbolizer -obj=%t.o < %t.input | FileCheck %s
+# RUN: llvm-symbolizer -obj=%t.aranges.o < %t.input | FileCheck %s
+
+# GCC emits the definitions of the methods of local classes and lambdas in
+# the class DIEs. The walk looking for subprograms must not skip these
+# subtrees, whether .debug_aranges gives the unit for an address or the unit
+# ranges are collected from its subprograms.
+#
+# Generated from, and then simplified:
+#   int main() {
+#     struct Local { static int method(int x) { return x + 1; } };
+#     auto lambda = [](int x) { return x * 2; };
+#     return Local::method(1) + lambda(2);
+#   }
+
+# CHECK:      method
+# CHECK-NEXT: ??:0
+# CHECK:      operator()
+# CHECK-NEXT: ??:0
+# CHECK:      main
+# CHECK-NEXT: ??:0
+
+	.section	.debug_abbrev,"",@progbits
+.Lsection_abbrev:
+	.byte	1                       # Abbreviation Code
+	.byte	17                      # DW_TAG_compile_unit
+	.byte	1                       # DW_CHILDREN_yes
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	2                       # Abbreviation Code
+	.byte	46                      # DW_TAG_subprogram
+	.byte	1                       # DW_CHILDREN_yes
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	17                      # DW_AT_low_pc
+	.byte	1                       # DW_FORM_addr
+	.byte	18                      # DW_AT_high_pc
+	.byte	6                       # DW_FORM_data4
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	3                       # Abbreviation Code
+	.byte	19                      # DW_TAG_structure_type
+	.byte	1                       # DW_CHILDREN_yes
+	.byte	1                       # DW_AT_sibling
+	.byte	19                      # DW_FORM_ref4
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	4                       # Abbreviation Code
+	.byte	46                      # DW_TAG_subprogram
+	.byte	0                       # DW_CHILDREN_no
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	17                      # DW_AT_low_pc
+	.byte	1                       # DW_FORM_addr
+	.byte	18                      # DW_AT_high_pc
+	.byte	6                       # DW_FORM_data4
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	5                       # Abbreviation Code
+	.byte	46                      # DW_TAG_subprogram
+	.byte	0                       # DW_CHILDREN_no
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	60                      # DW_AT_declaration
+	.byte	25                      # DW_FORM_flag_present
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	0                       # EOM(3)
+
+	.section	.debug_info,"",@progbits
+.Lcu_begin0:
+	.long	.Lcu_end0-.Lcu_version0 # Length of Unit
+.Lcu_version0:
+	.short	4                       # DWARF version number
+	.long	.Lsection_abbrev        # Offset Into Abbrev. Section
+	.byte	8                       # Address Size (in bytes)
+	.byte	1                       # Abbrev [1] DW_TAG_compile_unit
+	.asciz	"local.cpp"             # DW_AT_name
+	.byte	2                       # Abbrev [2] DW_TAG_subprogram
+	.asciz	"main"                  # DW_AT_name
+	.quad	0x1020                  # DW_AT_low_pc
+	.long	0x20                    # DW_AT_high_pc
+	.byte	3                       # Abbrev [3] DW_TAG_structure_type
+	.long	.Llambda-.Lcu_begin0    # DW_AT_sibling
+	.byte	4                       # Abbrev [4] DW_TAG_subprogram
+	.asciz	"method"                # DW_AT_name
+	.quad	0x1000                  # DW_AT_low_pc
+	.long	0x10                    # DW_AT_high_pc
+	.byte	0                       # End Of Children Mark
+.Llambda:
+	.byte	3                       # Abbrev [3] DW_TAG_structure_type
+	.long	.Lmain_end-.Lcu_begin0  # DW_AT_sibling
+	.byte	5                       # Abbrev [5] DW_TAG_subprogram
+	.asciz	"<lambda>"              # DW_AT_name
+	.byte	4                       # Abbrev [4] DW_TAG_subprogram
+	.asciz	"operator()"            # DW_AT_name
+	.quad	0x1010                  # DW_AT_low_pc
+	.long	0x10                    # DW_AT_high_pc
+	.byte	0                       # End Of Children Mark
+.Lmain_end:
+	.byte	0                       # End Of Children Mark
+	.byte	0                       # End Of Children Mark
+.Lcu_end0:
+
+.ifdef ARANGES
+	.section	.debug_aranges,"",@progbits
+	.long	.Laranges_end-.Laranges_version # Length of ARange Set
+.Laranges_version:
+	.short	2                       # DWARF Arange version number
+	.long	.Lcu_begin0             # Offset Into Debug Info Section
+	.byte	8                       # Address Size (in bytes)
+	.byte	0                       # Segment Size (in bytes)
+	.zero	4,255                   # Padding
+	.quad	0x1000                  # ARange Start
+	.quad	0x40                    # ARange Length
+	.quad	0                       # ARange terminator
+	.quad	0
+.Laranges_end:
+.endif
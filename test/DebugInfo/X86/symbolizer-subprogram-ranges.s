@@ -0,0 +1,117 @@
+# RUN: llvm-mc -triple x86_64-pc-linux -filetype=obj %s -o %t.o
+# RUN: echo "0x2004" > %t.input
+# RUN: echo "0x200a" >> %t.input
+# RUN: echo "0x2014" >> %t.input
+# RUN: echo "0x2034" >> %t.input
+# RUN: echo "0x2044" >> %t.input
+# RUN: echo "0x2060" >> %t.input
+# RUN: llvm-symbolizer -obj=%t.o -inlining < %t.input | FileCheck %s
+
+# The subprogram ranges of a unit are indexed by address. Where ranges
+# overlap, an address belongs to the earliest subprogram DIE that covers it:
+# - "nested" is nested in "outer", which comes first and owns 0x200a; the
+#   chain of 0x200a then goes down to "nested" like an inlined chain does;
+# - "overlap" starts inside "outer", which owns 0x2034 but not 0x2044.
+
+# CHECK:      outer
+# CHECK-NEXT: ??:0
+# CHECK:      nested
+# CHECK-NEXT: ??:0
+# CHECK-NEXT: outer
+# CHECK-NEXT: ??:0
+# CHECK:      inl
+# CHECK-NEXT: ??:0
+# CHECK-NEXT: outer
+# CHECK-NEXT: ??:0
+# CHECK:      outer
+# CHECK-NEXT: ??:0
+# CHECK:      overlap
+# CHECK-NEXT: ??:0
+# CHECK:      {{^}}??{{$}}
+# CHECK-NEXT: ??:0
+
+	.section	.debug_abbrev,"",@progbits
+.Lsection_abbrev:
+	.byte	1                       # Abbreviation Code
+	.byte	17                      # DW_TAG_compile_unit
+	.byte	1                       # DW_CHILDREN_yes
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	2                       # Abbreviation Code
+	.byte	46                      # DW_TAG_subprogram
+	.byte	0                       # DW_CHILDREN_no
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	32                      # DW_AT_inline
+	.byte	11                      # DW_FORM_data1
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	3                       # Abbreviation Code
+	.byte	46                      # DW_TAG_subprogram
+	.byte	1                       # DW_CHILDREN_yes
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	17                      # DW_AT_low_pc
+	.byte	1                       # DW_FORM_addr
+	.byte	18                      # DW_AT_high_pc
+	.byte	6                       # DW_FORM_data4
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	4                       # Abbreviation Code
+	.byte	29                      # DW_TAG_inlined_subroutine
+	.byte	0                       # DW_CHILDREN_no
+	.byte	49                      # DW_AT_abstract_origin
+	.byte	19                      # DW_FORM_ref4
+	.byte	17                      # DW_AT_low_pc
+	.byte	1                       # DW_FORM_addr
+	.byte	18                      # DW_AT_high_pc
+	.byte	6                       # DW_FORM_data4
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	5                       # Abbreviation Code
+	.byte	46                      # DW_TAG_subprogram
+	.byte	0                       # DW_CHILDREN_no
+	.byte	3                       # DW_AT_name
+	.byte	8                       # DW_FORM_string
+	.byte	17                      # DW_AT_low_pc
+	.byte	1                       # DW_FORM_addr
+	.byte	18                      # DW_AT_high_pc
+	.byte	6                       # DW_FORM_data4
+	.byte	0                       # EOM(1)
+	.byte	0                       # EOM(2)
+	.byte	0                       # EOM(3)
+
+	.section	.debug_info,"",@progbits
+.Lcu_begin0:
+	.long	.Lcu_end0-.Lcu_version0 # Length of Unit
+.Lcu_version0:
+	.short	4                       # DWARF version number
+	.long	.Lsection_abbrev        # Offset Into Abbrev. Section
+	.byte	8                       # Address Size (in bytes)
+	.byte	1                       # Abbrev [1] DW_TAG_compile_unit
+	.asciz	"ranges.c"              # DW_AT_name
+.Linl:
+	.byte	2                       # Abbrev [2] DW_TAG_subprogram
+	.asciz	"inl"                   # DW_AT_name
+	.byte	1                       # DW_AT_inline
+	.byte	3                       # Abbrev [3] DW_TAG_subprogram
+	.asciz	"outer"                 # DW_AT_name
+	.quad	0x2000                  # DW_AT_low_pc
+	.long	0x40                    # DW_AT_high_pc
+	.byte	5                       # Abbrev [5] DW_TAG_subprogram
+	.asciz	"nested"                # DW_AT_name
+	.quad	0x2008                  # DW_AT_low_pc
+	.long	0x4                     # DW_AT_high_pc
+	.byte	4                       # Abbrev [4] DW_TAG_inlined_subroutine
+	.long	.Linl-.Lcu_begin0       # DW_AT_abstract_origin
+	.quad	0x2010                  # DW_AT_low_pc
+	.long	0x10                    # DW_AT_high_pc
+	.byte	0                       # End Of Children Mark
+	.byte	5                       # Abbrev [5] DW_TAG_subprogram
+	.asciz	"overlap"               # DW_AT_name
+	.quad	0x2030                  # DW_AT_low_pc
+	.long	0x20                    # DW_AT_high_pc
+	.byte	0                       # End Of Children Mark
+.Lcu_end0:
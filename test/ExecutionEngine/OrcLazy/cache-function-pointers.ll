@@ -0,0 +1,35 @@
+; RUN: rm -rf %t.cache
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-cache-dir=%t.cache %s | FileCheck %s
+; RUN: ls %t.cache > %t.entries
+; RUN: FileCheck %s --check-prefix=ENTRIES < %t.entries
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-cache-dir=%t.cache %s | FileCheck %s
+; RUN: ls %t.cache | diff %t.entries -
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-cache-dir=%t.cache %s | FileCheck %s
+; RUN: ls %t.cache | diff %t.entries -
+;
+; The initializer of @table points to the stub of @sq, whose address changes
+; from run to run. The module holding the globals must not be cached, or
+; every run would add an entry that is never read again.
+;
+; CHECK: 49
+;
+; ENTRIES: {{^[0-9a-f]+}}.o
+
+@fmt = private unnamed_addr constant [4 x i8] c"%d\0A\00"
+@table = global i32 (i32)* @sq
+
+declare i32 @printf(i8* nocapture readonly, ...)
+
+define i32 @sq(i32 %x) {
+entry:
+  %r = mul i32 %x, %x
+  ret i32 %r
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %f = load i32 (i32)*, i32 (i32)** @table
+  %v = call i32 %f(i32 7)
+  %p = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([4 x i8], [4 x i8]* @fmt, i64 0, i64 0), i32 %v)
+  ret i32 0
+}
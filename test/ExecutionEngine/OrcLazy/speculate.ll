@@ -0,0 +1,45 @@
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-speculate %s | FileCheck %s
+;
+; Compiling main and sum_squares queues their callees for compilation in the
+; background. The program must run the same whether the callees were
+; compiled ahead or not.
+;
+; CHECK: Hello
+; CHECK-NEXT: 285
+
+@str = private unnamed_addr constant [6 x i8] c"Hello\00"
+@fmt = private unnamed_addr constant [4 x i8] c"%d\0A\00"
+
+declare i32 @puts(i8* nocapture readonly)
+declare i32 @printf(i8* nocapture readonly, ...)
+
+define i32 @square(i32 %x) {
+entry:
+  %r = mul i32 %x, %x
+  ret i32 %r
+}
+
+define i32 @sum_squares(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %s = call i32 @square(i32 %i)
+  %acc.next = add i32 %acc, %s
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %acc.next
+}
+
+define i32 @main(i32 %argc, i8** nocapture readnone %argv) {
+entry:
+  %puts = call i32 @puts(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @str, i64 0, i64 0))
+  %v = call i32 @sum_squares(i32 10)
+  %p = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([4 x i8], [4 x i8]* @fmt, i64 0, i64 0), i32 %v)
+  ret i32 0
+}
@@ -0,0 +1,52 @@
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-tiered -orc-lazy-tier-up-threshold=10 \
+; RUN:     -debug-only=orc-lazy %s > %t.out 2> %t.err
+; RUN: FileCheck %s < %t.out
+; RUN: FileCheck %s --check-prefix=TIERUP < %t.err
+; REQUIRES: asserts
+;
+; The functions start at -O0 with counters on their entry and loop headers.
+; @sum is called 100 times and @main loops 100 times, so both are recompiled;
+; the output does not depend on when the new bodies are picked up.
+;
+; CHECK: 495000
+;
+; TIERUP-DAG: Recompiled hot function sum
+; TIERUP-DAG: Recompiled hot function main
+
+@fmt = private unnamed_addr constant [4 x i8] c"%d\0A\00"
+
+declare i32 @printf(i8*, ...)
+
+define i32 @sum(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %acc.next = add i32 %acc, %i
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 %acc.next
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  br label %loop
+
+loop:
+  %k = phi i32 [ 0, %entry ], [ %k.next, %loop ]
+  %total = phi i32 [ 0, %entry ], [ %total.next, %loop ]
+  %s = call i32 @sum(i32 100)
+  %total.next = add i32 %total, %s
+  %k.next = add i32 %k, 1
+  %done = icmp eq i32 %k.next, 100
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([4 x i8], [4 x i8]* @fmt, i64 0, i64 0), i32 %total.next)
+  ret i32 0
+}
@@ -0,0 +1,9 @@
+target triple = "x86_64-unknown-linux-gnu"
+
+@x = internal global i32 42
+
+define i32 @g() {
+entry:
+  %v = load i32, i32* @x
+  ret i32 %v
+}
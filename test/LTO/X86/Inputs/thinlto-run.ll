@@ -0,0 +1,6 @@
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @g() {
+entry:
+  ret i32 42
+}
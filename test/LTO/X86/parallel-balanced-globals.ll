@@ -0,0 +1,19 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=a -exported-symbol=b -exported-symbol=c \
+; RUN:     -j2 -split-codegen-partitions-per-output=2 -o %t.o %t.bc
+; RUN: llvm-nm %t.o.0 > %t.syms
+; RUN: llvm-nm %t.o.1 >> %t.syms
+; RUN: sort -k3 %t.syms | FileCheck %s
+
+; The module has no instructions, so no partition costs anything to generate
+; code for. Every output must still be written, and the globals must all be
+; in one of them.
+; CHECK: D a
+; CHECK-NEXT: D b
+; CHECK-NEXT: D c
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@a = global i32 1
+@b = global i32 2
+@c = global i32 3
@@ -0,0 +1,99 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=big -exported-symbol=s1 -exported-symbol=s2 \
+; RUN:     -exported-symbol=s4 -exported-symbol=s5 -exported-symbol=s6 \
+; RUN:     -exported-symbol=s7 -j2 -split-codegen-partitions-per-output=4 \
+; RUN:     -o %t.o %t.bc
+; RUN: llvm-nm %t.o.0 | FileCheck --check-prefix=OUT0 %s
+; RUN: llvm-nm %t.o.1 | sort -k3 | FileCheck --check-prefix=OUT1 %s
+
+; The module is split into 8 partitions, one per function here. The most
+; expensive one, @big, goes first to the first output; the small functions
+; then all go to the second output, which stays the least loaded.
+; OUT0-NOT: T s
+; OUT0: T big
+; OUT0-NOT: T s
+
+; OUT1-NOT: T big
+; OUT1: T s1
+; OUT1-NEXT: T s2
+; OUT1-NEXT: T s4
+; OUT1-NEXT: T s5
+; OUT1-NEXT: T s6
+; OUT1-NEXT: T s7
+; OUT1-NOT: T big
+
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @big(i32 %a) {
+  %v0 = mul i32 %a, %a
+  %v1 = mul i32 %v0, %a
+  %v2 = mul i32 %v1, %a
+  %v3 = mul i32 %v2, %a
+  %v4 = mul i32 %v3, %a
+  %v5 = mul i32 %v4, %a
+  %v6 = mul i32 %v5, %a
+  %v7 = mul i32 %v6, %a
+  %v8 = mul i32 %v7, %a
+  %v9 = mul i32 %v8, %a
+  %v10 = mul i32 %v9, %a
+  %v11 = mul i32 %v10, %a
+  %v12 = mul i32 %v11, %a
+  %v13 = mul i32 %v12, %a
+  %v14 = mul i32 %v13, %a
+  %v15 = mul i32 %v14, %a
+  %v16 = mul i32 %v15, %a
+  %v17 = mul i32 %v16, %a
+  %v18 = mul i32 %v17, %a
+  %v19 = mul i32 %v18, %a
+  %v20 = mul i32 %v19, %a
+  %v21 = mul i32 %v20, %a
+  %v22 = mul i32 %v21, %a
+  %v23 = mul i32 %v22, %a
+  %v24 = mul i32 %v23, %a
+  %v25 = mul i32 %v24, %a
+  %v26 = mul i32 %v25, %a
+  %v27 = mul i32 %v26, %a
+  %v28 = mul i32 %v27, %a
+  %v29 = mul i32 %v28, %a
+  %v30 = mul i32 %v29, %a
+  %v31 = mul i32 %v30, %a
+  %v32 = mul i32 %v31, %a
+  %v33 = mul i32 %v32, %a
+  %v34 = mul i32 %v33, %a
+  %v35 = mul i32 %v34, %a
+  %v36 = mul i32 %v35, %a
+  %v37 = mul i32 %v36, %a
+  %v38 = mul i32 %v37, %a
+  %v39 = mul i32 %v38, %a
+  ret i32 %v39
+}
+
+define i32 @s1(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+define i32 @s2(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+define i32 @s4(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+define i32 @s5(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+define i32 @s6(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+define i32 @s7(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
@@ -0,0 +1,23 @@
+; REQUIRES: asserts
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=bar -opt-threads=2 \
+; RUN:     -stats -o %t.o %t.bc 2>&1 | FileCheck %s
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=bar -opt-threads=1 \
+; RUN:     -stats -o %t.o %t.bc 2>&1 | FileCheck --check-prefix=SERIAL %s
+
+; Both partitions of the merged module went through the scalar passes.
+; CHECK: 2 lto - Number of module partitions optimized in parallel
+; SERIAL-NOT: module partitions optimized in parallel
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @foo(i32 %x) {
+  %a = add i32 %x, 1
+  ret i32 %a
+}
+
+define i32 @bar(i32 %x) {
+  %a = mul i32 %x, 3
+  ret i32 %a
+}
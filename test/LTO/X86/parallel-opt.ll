@@ -0,0 +1,51 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=bar -exported-symbol=h \
+; RUN:     -opt-threads=2 -save-merged-module -o %t.o %t.bc
+; RUN: llvm-dis -o - %t.o.merged.bc | FileCheck %s
+; RUN: llvm-dis -o - %t.o.merged.bc | FileCheck --check-prefix=FOO %s
+; RUN: llvm-dis -o - %t.o.merged.bc | FileCheck --check-prefix=BAR %s
+; RUN: llvm-nm %t.o | FileCheck --check-prefix=NM %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = internal global i32 0
+@h = global i32 0
+
+; The scalar passes ran on both partitions, and the internal global stayed with
+; the function using it.
+; CHECK-DAG: @g = internal unnamed_addr global i32 0
+; CHECK-DAG: @h = global i32 0
+
+; FOO-LABEL: define i32 @foo(
+; FOO-NEXT: load i32, i32* @g
+; FOO-NEXT: shl i32
+; FOO-NEXT: add i32
+; FOO-NEXT: store i32
+; FOO-NEXT: ret i32
+define i32 @foo(i32 %x) {
+  %a = load i32, i32* @g
+  %b = load i32, i32* @g
+  %c = add i32 %a, %b
+  %s = add i32 %c, %x
+  store i32 %s, i32* @g
+  %d = load i32, i32* @g
+  ret i32 %d
+}
+
+; BAR-LABEL: define i32 @bar(
+; BAR-NEXT: load i32, i32* @h
+; BAR-NEXT: shl i32
+; BAR-NEXT: store i32
+; BAR-NEXT: ret i32
+define i32 @bar() {
+  %a = load i32, i32* @h
+  %b = load i32, i32* @h
+  %c = add i32 %a, %b
+  store i32 %c, i32* @h
+  %d = load i32, i32* @h
+  ret i32 %d
+}
+
+; NM-DAG: T bar
+; NM-DAG: T foo
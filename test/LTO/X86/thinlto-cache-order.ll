@@ -0,0 +1,30 @@
+; The IDs of the modules come from the order of the inputs, and are part of
+; the names of the promoted locals: swapping the inputs must not reuse the
+; cached objects.
+; RUN: llvm-as -function-summary %s -o %t.bc
+; RUN: llvm-as -function-summary %p/Inputs/thinlto-cache-order.ll -o %t2.bc
+; RUN: rm -Rf %t.cache && mkdir %t.cache
+; RUN: llvm-lto -thinlto-action=run -thinlto-cache-dir %t.cache %t.bc %t2.bc
+; RUN: llvm-nm %t2.bc.thinlto.o > %t.syms
+; RUN: llvm-nm %t.bc.thinlto.o >> %t.syms
+; RUN: FileCheck %s --check-prefix=FIRST < %t.syms
+; RUN: llvm-lto -thinlto-action=run -thinlto-cache-dir %t.cache %t2.bc %t.bc
+; RUN: llvm-nm %t2.bc.thinlto.o > %t.syms
+; RUN: llvm-nm %t.bc.thinlto.o >> %t.syms
+; RUN: FileCheck %s --check-prefix=SWAPPED < %t.syms
+
+; @g is imported into this module, along with a reference to the promoted @x.
+; FIRST: D x.llvm.2
+; FIRST: U x.llvm.2
+; SWAPPED: D x.llvm.1
+; SWAPPED: U x.llvm.1
+
+target triple = "x86_64-unknown-linux-gnu"
+
+declare i32 @g()
+
+define i32 @f() {
+entry:
+  %r = call i32 @g()
+  ret i32 %r
+}
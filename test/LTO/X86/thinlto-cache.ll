@@ -0,0 +1,45 @@
+; Test the ThinLTO backend cache: the first run populates one entry per module,
+; a second run reuses them and produces the same objects.
+; RUN: llvm-as -function-summary %s -o %t.bc
+; RUN: llvm-as -function-summary %p/Inputs/thinlto-run.ll -o %t2.bc
+; RUN: rm -Rf %t.cache && mkdir %t.cache
+; RUN: llvm-lto -thinlto-action=run -thinlto-cache-dir %t.cache %t.bc %t2.bc
+; RUN: ls %t.cache | grep -c "^llvmcache-" | FileCheck %s --check-prefix=ENTRIES
+; RUN: cp %t.bc.thinlto.o %t.first.o
+; RUN: llvm-lto -thinlto-action=run -thinlto-cache-dir %t.cache %t.bc %t2.bc
+; RUN: cmp %t.bc.thinlto.o %t.first.o
+; RUN: ls %t.cache | grep -c "^llvmcache-" | FileCheck %s --check-prefix=ENTRIES
+
+; ENTRIES: 2
+
+; The objects really come from the cache: replace the entries and the outputs
+; follow.
+; RUN: echo "not an object from the backend" > %t.fake
+; RUN: ls %t.cache/llvmcache-* | xargs -n 1 cp %t.fake
+; RUN: llvm-lto -thinlto-action=run -thinlto-cache-dir %t.cache %t.bc %t2.bc
+; RUN: FileCheck %s --check-prefix=HIT < %t.bc.thinlto.o
+; RUN: FileCheck %s --check-prefix=HIT < %t2.bc.thinlto.o
+; RUN: ls %t.cache | grep -c "^llvmcache-" | FileCheck %s --check-prefix=ENTRIES
+
+; HIT: not an object from the backend
+
+; A size limit of one byte prunes every entry at the end of the run, but not
+; the temporary file of an entry another process is writing.
+; RUN: echo "in flight" > %t.cache/llvmcache-0123.tmp456789
+; RUN: llvm-lto -thinlto-action=run -thinlto-cache-dir %t.cache \
+; RUN:   -thinlto-cache-pruning-interval 0 -thinlto-cache-max-size 1 %t.bc %t2.bc
+; RUN: ls %t.cache | FileCheck %s --check-prefix=PRUNED
+
+; PRUNED-NOT: llvmcache-
+; PRUNED: llvmcache-0123.tmp456789
+; PRUNED-NOT: llvmcache-
+
+target triple = "x86_64-unknown-linux-gnu"
+
+declare i32 @g()
+
+define i32 @f() {
+entry:
+  %r = call i32 @g()
+  ret i32 %r
+}
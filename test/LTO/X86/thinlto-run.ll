@@ -0,0 +1,23 @@
+; Test the end-to-end ThinLTO pipeline in llvm-lto: one object is produced per
+; input module, and the callee from the other module gets imported.
+; RUN: llvm-as -function-summary %s -o %t.bc
+; RUN: llvm-as -function-summary %p/Inputs/thinlto-run.ll -o %t2.bc
+; RUN: llvm-lto -thinlto-action=run -j2 %t.bc %t2.bc
+; RUN: llvm-nm %t.bc.thinlto.o | FileCheck %s --check-prefix=NM1
+; RUN: llvm-nm %t2.bc.thinlto.o | FileCheck %s --check-prefix=NM2
+
+; The call to @g is inlined after import, @g is not referenced anymore.
+; NM1: T f
+; NM1-NOT: g
+
+; NM2: T g
+
+target triple = "x86_64-unknown-linux-gnu"
+
+declare i32 @g()
+
+define i32 @f() {
+entry:
+  %r = call i32 @g()
+  ret i32 %r
+}
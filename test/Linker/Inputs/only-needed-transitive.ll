@@ -0,0 +1,16 @@
+define i32 @foo() {
+  %r = call i32 @bar()
+  ret i32 %r
+}
+
+define i32 @bar() {
+  %r = load i32, i32* @X
+  ret i32 %r
+}
+
+@X = global i32 5
+
+define i32 @unused() {
+  %r = call i32 @bar()
+  ret i32 %r
+}
@@ -0,0 +1,22 @@
+; With -only-needed, the definitions referenced by the needed values are
+; linked too, and the unreachable ones are left out.
+; RUN: llvm-link -S -only-needed %s %p/Inputs/only-needed-transitive.ll | FileCheck %s
+; RUN: llvm-link -S -internalize -only-needed %s %p/Inputs/only-needed-transitive.ll | FileCheck %s -check-prefix=INTERNALIZE
+; RUN: llvm-link -S -only-needed %s %p/Inputs/only-needed-transitive.ll | FileCheck %s -check-prefix=UNUSED
+
+; CHECK-DAG: @X = global i32 5
+; CHECK-DAG: define i32 @foo()
+; CHECK-DAG: define i32 @bar()
+
+; INTERNALIZE-DAG: @X = internal global i32 5
+; INTERNALIZE-DAG: define internal i32 @foo()
+; INTERNALIZE-DAG: define internal i32 @bar()
+
+; UNUSED-NOT: @unused
+
+declare i32 @foo()
+
+define i32 @main() {
+  %r = call i32 @foo()
+  ret i32 %r
+}
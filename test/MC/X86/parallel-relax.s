@@ -0,0 +1,33 @@
+// Relaxing the independent sections in parallel produces the same object as
+// the serial layout.
+
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o %t.serial.o
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu -mc-layout-threads=4 \
+// RUN:     %s -o %t.o
+// RUN: cmp %t.serial.o %t.o
+// RUN: llvm-objdump -disassemble %t.o | FileCheck %s
+
+// CHECK-LABEL: section .text.a:
+// CHECK:       0: eb fe
+        .section .text.a,"ax",@progbits
+a:
+        jmp a
+
+// CHECK-LABEL: section .text.b:
+// CHECK:       0: e9 c8 00 00 00
+        .section .text.b,"ax",@progbits
+        jmp 1f
+        .fill 200, 1, 0x90
+1:
+        ret
+
+// CHECK-LABEL: section .text.c:
+// CHECK:       0: e9 00 00 00 00
+        .section .text.c,"ax",@progbits
+        jmp ext
+
+// The jump to another section is relaxed by the serial layout.
+// CHECK-LABEL: section .text.d:
+// CHECK:       0: e9 00 00 00 00
+        .section .text.d,"ax",@progbits
+        jmp a
@@ -0,0 +1,82 @@
+; The IR below was crafted so as:
+; 1) To have a loop, so we create a loop info and a dominator tree.
+; 2) To have redundancies early-cse, instcombine and adce remove, without
+;    changing the CFG.
+;
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='default<O0>' %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=CHECK-O0
+; CHECK-O0: Starting pass manager
+; CHECK-O0-NEXT: Running pass: PassManager
+; CHECK-O0-NEXT: Starting pass manager
+; CHECK-O0-NEXT: Running pass: ForceFunctionAttrsPass
+; CHECK-O0-NEXT: Finished pass manager
+; CHECK-O0-NEXT: Finished pass manager
+
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='default<O1>' %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=CHECK-O
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='default<O2>' %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=CHECK-O
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='default<O3>' %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=CHECK-O
+; CHECK-O: Running pass: ForceFunctionAttrsPass
+; CHECK-O: Running pass: InferFunctionAttrsPass
+; CHECK-O: Running pass: ModuleToFunctionPassAdaptor
+; CHECK-O: Running pass: SimplifyCFGPass
+; CHECK-O: Running pass: SROA
+; CHECK-O: Running pass: EarlyCSEPass
+; CHECK-O: Running pass: LowerExpectIntrinsicPass
+; CHECK-O: Running pass: ModuleToFunctionPassAdaptor
+; CHECK-O: Running pass: SROA
+; CHECK-O: Running pass: EarlyCSEPass
+; CHECK-O: Running pass: SimplifyCFGPass
+; CHECK-O: Running pass: InstCombinePass
+; CHECK-O: Running pass: ADCEPass
+; CHECK-O: Running pass: SimplifyCFGPass
+; CHECK-O: Running pass: InstCombinePass
+; CHECK-O: Running pass: StripDeadPrototypesPass
+
+; The passes which don't change the CFG keep the dominator tree and the loop
+; info alive.
+; RUN: opt -disable-output -disable-verify -debug-pass-manager \
+; RUN:     -passes='function(require<domtree>,require<loops>,sroa,early-cse,instcombine,adce,lower-expect,require<domtree>,require<loops>)' %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=CHECK-PRESERVE
+; CHECK-PRESERVE: Running analysis: DominatorTreeAnalysis
+; CHECK-PRESERVE: Running analysis: LoopAnalysis
+; CHECK-PRESERVE-NOT: Invalidating analysis: DominatorTreeAnalysis
+; CHECK-PRESERVE-NOT: Invalidating analysis: LoopAnalysis
+; CHECK-PRESERVE-NOT: Running analysis: DominatorTreeAnalysis
+; CHECK-PRESERVE-NOT: Running analysis: LoopAnalysis
+; CHECK-PRESERVE: Finished pass manager
+
+declare i64 @llvm.expect.i64(i64, i64)
+
+define i32 @foo(i32* %p, i32 %n) {
+entry:
+  %a = alloca i32
+  store i32 0, i32* %a
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %v1 = load i32, i32* %p
+  %v2 = load i32, i32* %p
+  %sum = add i32 %v1, %v2
+  %dead = mul i32 %sum, 3
+  %old = load i32, i32* %a
+  %new = add i32 %old, %sum
+  store i32 %new, i32* %a
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  %cmp.ext = zext i1 %cmp to i64
+  %expval = call i64 @llvm.expect.i64(i64 %cmp.ext, i64 1)
+  %tobool = icmp ne i64 %expval, 0
+  br i1 %tobool, label %loop, label %exit
+
+exit:
+  %r = load i32, i32* %a
+  ret i32 %r
+}
@@ -0,0 +1,27 @@
+; RUN: opt -instcombine -licm -pass-trace=%t.json -disable-output %s
+; RUN: FileCheck %s < %t.json
+
+; CHECK: {"traceEvents":[
+; CHECK-DAG: {"name":"Combine redundant instructions","cat":"function","ph":"X",{{.*}}"args":{"ir":"foo","instructions":1,"instructions_delta":-1,
+; CHECK-DAG: {"name":"Loop Invariant Code Motion","cat":"loop","ph":"X",{{.*}}"args":{"ir":"loop",
+; CHECK: ]}
+
+define i32 @foo(i32 %a) {
+  %b = add i32 %a, 0
+  ret i32 %b
+}
+
+define void @bar(i32* %p, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  store i32 %i, i32* %p
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,55 @@
+; RUN: opt < %s -basicaa -dse -enable-dse-memssa -S | FileCheck %s
+
+; The store to a[i] reaches itself around the back-edge, but the next
+; iteration writes a[i+1], after reading a[i] back as a[i-1].
+define i32 @variant(i32 %n) {
+; CHECK-LABEL: @variant(
+; CHECK: loop:
+; CHECK: store i32 %v.next, i32* %p
+entry:
+  %a = alloca [4 x i32]
+  %a0 = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 0
+  store i32 1, i32* %a0
+  br label %loop
+
+loop:
+  %i = phi i32 [ 1, %entry ], [ %i.next, %loop ]
+  %i.prev = add i32 %i, -1
+  %q = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 %i.prev
+  %v = load i32, i32* %q
+  %v.next = add i32 %v, 1
+  %p = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 %i
+  store i32 %v.next, i32* %p
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %v.next
+}
+
+; Every iteration writes the same a[1], so the earlier store is overwritten
+; in the loop before the load can see it.
+define i32 @invariant(i32 %n) {
+; CHECK-LABEL: @invariant(
+; CHECK: entry:
+; CHECK-NOT: store
+; CHECK: loop:
+; CHECK: store i32 %i, i32* %p
+entry:
+  %a = alloca [4 x i32]
+  %p = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 1
+  store i32 7, i32* %p
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  store i32 %i, i32* %p
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  %v = load i32, i32* %p
+  ret i32 %v
+}
@@ -0,0 +1,116 @@
+; RUN: opt < %s -basicaa -dse -enable-dse-memssa -S | FileCheck %s
+
+declare void @g()
+declare void @use(i32*)
+
+; The first store is overwritten on both paths of the diamond.
+define void @diamond(i32* %p, i1 %c) {
+; CHECK-LABEL: @diamond(
+; CHECK-NOT: store i32 1
+; CHECK: store i32 2
+; CHECK: store i32 3
+entry:
+  store i32 1, i32* %p
+  br i1 %c, label %then, label %else
+
+then:
+  store i32 2, i32* %p
+  br label %exit
+
+else:
+  store i32 3, i32* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; The store is only overwritten on one path.
+define void @partial(i32* %p, i1 %c) {
+; CHECK-LABEL: @partial(
+; CHECK: store i32 1
+; CHECK: store i32 2
+entry:
+  store i32 1, i32* %p
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 2, i32* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A call that may read the location keeps the store alive.
+define void @read(i32* %p) {
+; CHECK-LABEL: @read(
+; CHECK: store i32 1
+; CHECK: store i32 2
+entry:
+  store i32 1, i32* %p
+  br label %next
+
+next:
+  call void @g()
+  store i32 2, i32* %p
+  ret void
+}
+
+; A store to a local object which isn't read before the function returns.
+define void @local(i1 %c) {
+; CHECK-LABEL: @local(
+; CHECK-NOT: store
+; CHECK: ret void
+entry:
+  %a = alloca i32
+  store i32 1, i32* %a
+  br i1 %c, label %then, label %exit
+
+then:
+  call void @g()
+  br label %exit
+
+exit:
+  ret void
+}
+
+; The local object is read on one path.
+define void @local_read(i1 %c) {
+; CHECK-LABEL: @local_read(
+; CHECK: store i32 1
+entry:
+  %a = alloca i32
+  store i32 1, i32* %a
+  br i1 %c, label %then, label %exit
+
+then:
+  call void @use(i32* %a)
+  br label %exit
+
+exit:
+  ret void
+}
+
+; The store in the loop is overwritten after the loop, and by itself in the
+; next iteration.
+define void @loop(i32* %p, i32 %n) {
+; CHECK-LABEL: @loop(
+; CHECK: loop:
+; CHECK-NOT: store
+; CHECK: exit:
+; CHECK-NEXT: store i32 0
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  store i32 %i, i32* %p
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  store i32 0, i32* %p
+  ret void
+}
@@ -0,0 +1,73 @@
+; RUN: opt < %s -basicaa -gvn -enable-gvn-memssa -S | FileCheck %s
+
+declare i32 @f(i32*) readonly
+declare void @g()
+
+; A load is replaced by the value of its clobbering store, non-aliasing stores
+; in between are skipped.
+define i32 @store_forward(i32* %p, i32* noalias %q, i32 %a) {
+; CHECK-LABEL: @store_forward(
+; CHECK-NOT: load
+; CHECK: ret i32 %a
+  store i32 %a, i32* %p
+  store i32 0, i32* %q
+  %v = load i32, i32* %p
+  ret i32 %v
+}
+
+; A load is replaced by a dominating load reading the same memory state, across
+; blocks that don't write the loaded location.
+define i32 @load_load(i32* %p, i32* noalias %q, i1 %c) {
+; CHECK-LABEL: @load_load(
+; CHECK: %v1 = load i32, i32* %p
+; CHECK-NOT: load
+; CHECK: add i32 %v1, %v1
+entry:
+  %v1 = load i32, i32* %p
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 0, i32* %q
+  br label %exit
+
+exit:
+  %v2 = load i32, i32* %p
+  %r = add i32 %v1, %v2
+  ret i32 %r
+}
+
+; A clobbering call in between keeps both loads.
+define i32 @clobbered(i32* %p) {
+; CHECK-LABEL: @clobbered(
+; CHECK: %v1 = load i32, i32* %p
+; CHECK: call void @g()
+; CHECK: %v2 = load i32, i32* %p
+  %v1 = load i32, i32* %p
+  call void @g()
+  %v2 = load i32, i32* %p
+  %r = add i32 %v1, %v2
+  ret i32 %r
+}
+
+; Read-only calls reading the same memory state compute the same value.
+define i32 @readonly_call(i32* %p) {
+; CHECK-LABEL: @readonly_call(
+; CHECK: %c1 = call i32 @f(i32* %p)
+; CHECK-NOT: call
+; CHECK: add i32 %c1, %c1
+  %c1 = call i32 @f(i32* %p)
+  %c2 = call i32 @f(i32* %p)
+  %r = add i32 %c1, %c2
+  ret i32 %r
+}
+
+; Volatile loads are never eliminated.
+define i32 @volatile(i32* %p) {
+; CHECK-LABEL: @volatile(
+; CHECK: load volatile i32, i32* %p
+; CHECK: load volatile i32, i32* %p
+  %v1 = load volatile i32, i32* %p
+  %v2 = load volatile i32, i32* %p
+  %r = add i32 %v1, %v2
+  ret i32 %r
+}
@@ -50,6 +50,16 @@ void BinaryHolder::changeBackingMemoryBuffer(
   CurrentMemoryBuffer = std::move(Buf);
 }
 
+void BinaryHolder::shareArchive(const BinaryHolder &Other) {
+  if (Other.CurrentArchives.empty())
+    return;
+
+  CurrentObjectFiles.clear();
+  CurrentArchives = Other.CurrentArchives;
+  CurrentFatBinary = Other.CurrentFatBinary;
+  CurrentMemoryBuffer = Other.CurrentMemoryBuffer;
+}
+
 ErrorOr<std::vector<MemoryBufferRef>>
 BinaryHolder::GetMemoryBuffersForFile(StringRef Filename,
                                       sys::TimeValue Timestamp) {
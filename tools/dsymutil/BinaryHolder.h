@@ -36,12 +36,13 @@ namespace dsymutil {
 /// archive file (Which is always the case in debug maps).
 /// Currently it only owns one memory buffer at any given time,
 /// meaning that a mapping request will invalidate the previous memory
-/// mapping.
+/// mapping. A mapped archive can be shared with other holders (see
+/// shareArchive()), it stays mapped until none of them uses it.
 class BinaryHolder {
-  std::vector<std::unique_ptr<object::Archive>> CurrentArchives;
-  std::unique_ptr<MemoryBuffer> CurrentMemoryBuffer;
+  std::vector<std::shared_ptr<object::Archive>> CurrentArchives;
+  std::shared_ptr<MemoryBuffer> CurrentMemoryBuffer;
   std::vector<std::unique_ptr<object::ObjectFile>> CurrentObjectFiles;
-  std::unique_ptr<object::MachOUniversalBinary> CurrentFatBinary;
+  std::shared_ptr<object::MachOUniversalBinary> CurrentFatBinary;
   bool Verbose;
 
   /// Get the MemoryBufferRefs for the file specification in \p
@@ -92,6 +93,11 @@ public:
   GetObjectFiles(StringRef Filename,
                  sys::TimeValue Timestamp = sys::TimeValue::PosixZeroTime());
 
+  /// Reuse the archive currently mapped by \p Other, if any, so that
+  /// requests for its members don't map and index the archive again.
+  /// This invalidates the ObjectFiles owned by this holder.
+  void shareArchive(const BinaryHolder &Other);
+
   /// Wraps GetObjectFiles() to return a derived ObjectFile type.
   template <typename ObjectFileType>
   ErrorOr<std::vector<const ObjectFileType *>>
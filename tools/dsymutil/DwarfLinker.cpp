@@ -36,8 +36,10 @@
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include <mutex>
 #include <string>
 #include <tuple>
 
@@ -1112,8 +1114,7 @@ void DwarfStreamer::emitFDE(uint32_t CIEOffset, uint32_t AddrSize,
 class DwarfLinker {
 public:
   DwarfLinker(StringRef OutputFilename, const LinkOptions &Options)
-      : OutputFilename(OutputFilename), Options(Options),
-        BinHolder(Options.Verbose), LastCIEOffset(0) {}
+      : OutputFilename(OutputFilename), Options(Options), LastCIEOffset(0) {}
 
   /// \brief Link the contents of the DebugMap.
   bool link(const DebugMap &);
@@ -1420,11 +1421,46 @@ private:
   ErrorOr<const object::ObjectFile &> loadObject(BinaryHolder &BinaryHolder,
                                                  DebugMapObject &Obj,
                                                  const DebugMap &Map);
+
+  /// \brief Map the file of \p Obj in \p BinaryHolder and get its object
+  /// for \p TheTriple. Unlike loadObject(), this doesn't report errors.
+  static ErrorOr<const object::ObjectFile &>
+  mapObject(BinaryHolder &BinaryHolder, const DebugMapObject &Obj,
+            const Triple &TheTriple);
   /// @}
 
+  /// \brief The state of a debug map object that can be prepared ahead of
+  /// its link: the mapped object file and its parsed debug info.
+  struct LinkContext {
+    DebugMapObject &DMO;
+    BinaryHolder BinHolder;
+    const object::ObjectFile *ObjectFile;
+    std::unique_ptr<DWARFContextInMemory> DwarfContext;
+    /// The error encountered while loading the object, reported when the
+    /// object is linked so that the diagnostics stay ordered.
+    std::error_code EC;
+
+    LinkContext(DebugMapObject &DMO, bool Verbose)
+        : DMO(DMO), BinHolder(Verbose), ObjectFile(nullptr) {}
+  };
+
+  /// \brief The archive mapped for the last loaded archive member. The
+  /// contexts of the next members of that archive share it instead of
+  /// mapping the archive again.
+  struct SharedArchive {
+    BinaryHolder Holder;
+    std::mutex Lock;
+
+    SharedArchive(bool Verbose) : Holder(Verbose) {}
+  };
+
+  /// \brief Map the object of \p Context and extract its DIEs. This doesn't
+  /// touch the linker state and can run on a worker thread.
+  static void loadDebugObject(LinkContext &Context, const Triple &TheTriple,
+                              SharedArchive &Archive);
+
   std::string OutputFilename;
   LinkOptions Options;
-  BinaryHolder BinHolder;
   std::unique_ptr<DwarfStreamer> Streamer;
   uint64_t OutputDebugInfoSize;
   unsigned UnitID; ///< A unique ID that identifies each compile unit.
@@ -3263,15 +3299,19 @@ bool DwarfLinker::registerModuleReference(
 }
 
 ErrorOr<const object::ObjectFile &>
-DwarfLinker::loadObject(BinaryHolder &BinaryHolder, DebugMapObject &Obj,
-                        const DebugMap &Map) {
+DwarfLinker::mapObject(BinaryHolder &BinaryHolder, const DebugMapObject &Obj,
+                       const Triple &TheTriple) {
   auto ErrOrObjs =
       BinaryHolder.GetObjectFiles(Obj.getObjectFilename(), Obj.getTimestamp());
-  if (std::error_code EC = ErrOrObjs.getError()) {
-    reportWarning(Twine(Obj.getObjectFilename()) + ": " + EC.message());
+  if (std::error_code EC = ErrOrObjs.getError())
     return EC;
-  }
-  auto ErrOrObj = BinaryHolder.Get(Map.getTriple());
+  return BinaryHolder.Get(TheTriple);
+}
+
+ErrorOr<const object::ObjectFile &>
+DwarfLinker::loadObject(BinaryHolder &BinaryHolder, DebugMapObject &Obj,
+                        const DebugMap &Map) {
+  auto ErrOrObj = mapObject(BinaryHolder, Obj, Map.getTriple());
   if (std::error_code EC = ErrOrObj.getError())
     reportWarning(Twine(Obj.getObjectFilename()) + ": " + EC.message());
   return ErrOrObj;
@@ -3400,6 +3440,33 @@ void DwarfLinker::DIECloner::cloneAllCompileUnits(
   }
 }
 
+void DwarfLinker::loadDebugObject(LinkContext &Context,
+                                  const Triple &TheTriple,
+                                  SharedArchive &Archive) {
+  // Archive members are mapped one at a time, out of the archive of the
+  // previous member when they come from the same one.
+  std::unique_lock<std::mutex> ArchiveLock;
+  if (Context.DMO.getObjectFilename().endswith(")")) {
+    ArchiveLock = std::unique_lock<std::mutex>(Archive.Lock);
+    Context.BinHolder.shareArchive(Archive.Holder);
+  }
+  auto ErrOrObj = mapObject(Context.BinHolder, Context.DMO, TheTriple);
+  if (ArchiveLock) {
+    Archive.Holder.shareArchive(Context.BinHolder);
+    ArchiveLock.unlock();
+  }
+  if ((Context.EC = ErrOrObj.getError()))
+    return;
+  Context.ObjectFile = &*ErrOrObj;
+
+  // Setup access to the debug info, and extract all the DIEs: the link needs
+  // every one of them.
+  Context.DwarfContext =
+      llvm::make_unique<DWARFContextInMemory>(*Context.ObjectFile);
+  for (const auto &CU : Context.DwarfContext->compile_units())
+    CU->getNumDIEs();
+}
+
 bool DwarfLinker::link(const DebugMap &Map) {
 
   if (!createStreamer(Map.getTriple(), OutputFilename))
@@ -3411,25 +3478,59 @@ bool DwarfLinker::link(const DebugMap &Map) {
   UnitID = 0;
   DebugMap ModuleMap(Map.getTriple(), Map.getBinaryPath());
 
-  for (const auto &Obj : Map.objects()) {
-    CurrentDebugObject = Obj.get();
+  // The objects are loaded and their DIEs extracted on worker threads, up to
+  // Options.Threads objects ahead of the link. The link itself, which relies
+  // on the ODR contexts and the string pool built by the previous objects,
+  // processes the objects in order on this thread.
+  std::vector<std::unique_ptr<LinkContext>> Contexts;
+  for (const auto &Obj : Map.objects())
+    Contexts.push_back(llvm::make_unique<LinkContext>(*Obj, Options.Verbose));
+  SharedArchive Archive(Options.Verbose);
+
+  std::unique_ptr<ThreadPool> Pool;
+  if (Options.Threads > 1)
+    Pool = llvm::make_unique<ThreadPool>(Options.Threads - 1);
+  std::vector<std::shared_future<ThreadPool::VoidTy>> Loaded(Contexts.size());
+  unsigned NextToLoad = 0;
+
+  for (unsigned I = 0, E = Contexts.size(); I != E; ++I) {
+    LinkContext &Context = *Contexts[I];
+    DebugMapObject *Obj = &Context.DMO;
+    CurrentDebugObject = Obj;
 
     if (Options.Verbose)
       outs() << "DEBUG MAP OBJECT: " << Obj->getObjectFilename() << "\n";
-    auto ErrOrObj = loadObject(BinHolder, *Obj, Map);
-    if (!ErrOrObj)
+    if (Pool) {
+      for (; NextToLoad < E && NextToLoad < I + Options.Threads;
+           ++NextToLoad) {
+        LinkContext *ToLoad = Contexts[NextToLoad].get();
+        Loaded[NextToLoad] = Pool->async([ToLoad, &Map, &Archive] {
+          loadDebugObject(*ToLoad, Map.getTriple(), Archive);
+        });
+      }
+      Loaded[I].wait();
+    } else {
+      loadDebugObject(Context, Map.getTriple(), Archive);
+    }
+
+    // Release the object file and the debug info when done with the object.
+    std::unique_ptr<LinkContext> ContextHolder = std::move(Contexts[I]);
+
+    if (Context.EC) {
+      reportWarning(Twine(Obj->getObjectFilename()) + ": " +
+                    Context.EC.message());
       continue;
+    }
 
     // Look for relocations that correspond to debug map entries.
     RelocationManager RelocMgr(*this);
-    if (!RelocMgr.findValidRelocsInDebugInfo(*ErrOrObj, *Obj)) {
+    if (!RelocMgr.findValidRelocsInDebugInfo(*Context.ObjectFile, *Obj)) {
       if (Options.Verbose)
         outs() << "No valid relocations found. Skipping.\n";
       continue;
     }
 
-    // Setup access to the debug info.
-    DWARFContextInMemory DwarfContext(*ErrOrObj);
+    DWARFContextInMemory &DwarfContext = *Context.DwarfContext;
     startDebugObject(DwarfContext, *Obj);
 
     // In a first phase, just read in the debug info and load all clang modules.
@@ -26,6 +26,7 @@
 #include "llvm/Support/TargetSelect.h"
 #include <cstdint>
 #include <string>
+#include <thread>
 
 using namespace llvm::dsymutil;
 
@@ -82,6 +83,16 @@ static opt<bool>
           desc("Do not use ODR (One Definition Rule) for type uniquing."),
           init(false), cat(DsymCategory));
 
+static opt<unsigned> NumThreads(
+    "num-threads",
+    desc("Specifies the maximum number (n) of simultaneous threads to use\n"
+         "when linking the debug info. The objects are loaded and their\n"
+         "debug info parsed on n-1 threads ahead of the link. Defaults to\n"
+         "the number of hardware threads, and to 1 with -verbose."),
+    init(0), cat(DsymCategory));
+static alias NumThreadsA("j", desc("Alias for --num-threads"),
+                         aliasopt(NumThreads));
+
 static opt<bool> DumpDebugMap(
     "dump-debug-map",
     desc("Parse and dump the debug map to standard output. Not DWARF link "
@@ -263,6 +274,14 @@ int main(int argc, char **argv) {
   Options.NoODR = NoODR;
   Options.PrependPath = OsoPrependPath;
 
+  // The verbose output of the loading of the objects would interleave with
+  // the one of the link.
+  Options.Threads = NumThreads;
+  if (Options.Threads == 0)
+    Options.Threads = std::thread::hardware_concurrency();
+  if (Options.Verbose || Options.Threads == 0)
+    Options.Threads = 1;
+
   llvm::InitializeAllTargetInfos();
   llvm::InitializeAllTargetMCs();
   llvm::InitializeAllTargets();
@@ -8,14 +8,28 @@
 //===----------------------------------------------------------------------===//
 
 #include "OrcLazyJIT.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/ExecutionEngine/Orc/OrcArchitectureSupport.h"
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include <cstdio>
 #include <system_error>
 
 using namespace llvm;
 
+#define DEBUG_TYPE "orc-lazy"
+
 namespace {
 
   enum class DumpKind { NoDump, DumpFuncsToStdOut, DumpModsToStdErr,
@@ -44,6 +58,30 @@ namespace {
   cl::opt<bool> OrcInlineStubs("orc-lazy-inline-stubs",
                                cl::desc("Try to inline stubs"),
                                cl::init(true), cl::Hidden);
+
+  cl::opt<std::string>
+  OrcCacheDir("orc-lazy-cache-dir",
+              cl::desc("Directory in which to keep the compiled partitions "
+                       "across runs"),
+              cl::init(""), cl::Hidden);
+
+  cl::opt<bool> OrcSpeculate("orc-lazy-speculate",
+                             cl::desc("Compile the callees of each compiled "
+                                      "function in the background"),
+                             cl::init(false), cl::Hidden);
+
+  cl::opt<bool> OrcTiered("orc-lazy-tiered",
+                          cl::desc("Compile functions at -O0 first, and "
+                                   "recompile the hot ones at -O2 or more in "
+                                   "the background"),
+                          cl::init(false), cl::Hidden);
+
+  cl::opt<unsigned>
+  OrcTierUpThreshold("orc-lazy-tier-up-threshold",
+                     cl::desc("Number of calls and loop iterations after "
+                              "which a function is recompiled, with "
+                              "-orc-lazy-tiered"),
+                     cl::init(1000), cl::Hidden);
 }
 
 std::unique_ptr<OrcLazyJIT::CompileCallbackMgr>
@@ -121,6 +159,147 @@ OrcLazyJIT::TransformFtor OrcLazyJIT::createDebugDumper() {
   llvm_unreachable("Unknown DumpKind");
 }
 
+OrcLazyJIT::TransformFtor OrcLazyJIT::createTransform() {
+  auto DebugDumper = createDebugDumper();
+  return [this, DebugDumper](std::unique_ptr<Module> M) {
+    if (Tier2)
+      M = addTierUpCounters(std::move(M));
+    return DebugDumper(std::move(M));
+  };
+}
+
+std::unique_ptr<Module>
+OrcLazyJIT::addTierUpCounters(std::unique_ptr<Module> M) {
+  // The available_externally definitions are the inlinable stubs.
+  SmallVector<Function *, 1> Fns;
+  for (auto &F : *M)
+    if (!F.isDeclaration() && !F.hasAvailableExternallyLinkage())
+      Fns.push_back(&F);
+  if (Fns.empty())
+    return M;
+
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream BitcodeStream(Bitcode);
+    WriteBitcodeToFile(M.get(), BitcodeStream);
+  }
+
+  LLVMContext &Context = M->getContext();
+  Type *IntPtrTy = M->getDataLayout().getIntPtrType(Context);
+  auto AddrOf = [IntPtrTy](uintptr_t Addr, Type *Ty) {
+    return ConstantExpr::getIntToPtr(ConstantInt::get(IntPtrTy, Addr), Ty);
+  };
+  Type *Int8PtrTy = Type::getInt8PtrTy(Context);
+  Constant *TierUpFn = AddrOf(
+      reinterpret_cast<uintptr_t>(&tierUp),
+      FunctionType::get(Type::getVoidTy(Context), Int8PtrTy, false)
+          ->getPointerTo());
+
+  for (auto *F : Fns) {
+    Tier2->Functions.emplace_back(*this, mangle(F->getName()));
+    TieredFunction &TF = Tier2->Functions.back();
+    TF.Bitcode = Bitcode;
+
+    // Count the calls and the loop iterations: bump the counter in the entry
+    // block, after the static allocas, and in the targets of back edges.
+    SmallVector<Instruction *, 8> CountPoints;
+    {
+      auto EntryPt = F->getEntryBlock().getFirstInsertionPt();
+      while (isa<AllocaInst>(EntryPt))
+        ++EntryPt;
+      CountPoints.push_back(&*EntryPt);
+
+      DominatorTree DT(*F);
+      SmallSetVector<BasicBlock *, 8> Headers;
+      for (auto &BB : *F)
+        for (auto *Succ : successors(&BB))
+          if (DT.dominates(Succ, &BB))
+            Headers.insert(Succ);
+      for (auto *Header : Headers) {
+        auto HeaderPt = Header->getFirstInsertionPt();
+        if (HeaderPt != Header->end())
+          CountPoints.push_back(&*HeaderPt);
+      }
+    }
+
+    Constant *Counter = AddrOf(reinterpret_cast<uintptr_t>(&TF.Counter),
+                               Type::getInt64PtrTy(Context));
+    Constant *TFAddr = AddrOf(reinterpret_cast<uintptr_t>(&TF), Int8PtrTy);
+    for (auto *I : CountPoints) {
+      IRBuilder<> B(I);
+      Value *Count = B.CreateAdd(B.CreateLoad(Counter), B.getInt64(1));
+      B.CreateStore(Count, Counter);
+      Value *Hot = B.CreateICmpEQ(Count, B.getInt64(Tier2->Threshold));
+      IRBuilder<> ThenB(SplitBlockAndInsertIfThen(Hot, I, false));
+      ThenB.CreateCall(TierUpFn, TFAddr);
+    }
+  }
+
+  return M;
+}
+
+void OrcLazyJIT::tierUp(TieredFunction *TF) {
+  TF->JIT.Tier2->Pool.async([TF]() { TF->JIT.recompile(*TF); });
+}
+
+void OrcLazyJIT::recompile(TieredFunction &TF) {
+  LLVMContext Context;
+  auto M = parseBitcodeFile(
+      MemoryBufferRef(StringRef(TF.Bitcode.data(), TF.Bitcode.size()),
+                      TF.Name),
+      Context);
+  if (!M)
+    return;
+
+  TargetMachine &TM = *Tier2->TM;
+  {
+    PassManagerBuilder Builder;
+    Builder.OptLevel = TM.getOptLevel();
+    Builder.Inliner = createFunctionInliningPass(Builder.OptLevel, 0);
+
+    legacy::FunctionPassManager FPM(M->get());
+    FPM.add(createTargetTransformInfoWrapperPass(TM.getTargetIRAnalysis()));
+    Builder.populateFunctionPassManager(FPM);
+    FPM.doInitialization();
+    for (auto &F : **M)
+      FPM.run(F);
+    FPM.doFinalization();
+
+    legacy::PassManager MPM;
+    MPM.add(createTargetTransformInfoWrapperPass(TM.getTargetIRAnalysis()));
+    Builder.populateModulePassManager(MPM);
+    MPM.run(**M);
+  }
+
+  // The symbols the function refers to were resolved when its first tier was
+  // linked, so looking them up here does not compile anything.
+  std::shared_ptr<RuntimeDyld::SymbolResolver> Resolver =
+    orc::createLambdaResolver(
+      [this](const std::string &Name) {
+        if (auto Sym = CODLayer.findSymbol(Name, false))
+          return RuntimeDyld::SymbolInfo(Sym.getAddress(), Sym.getFlags());
+        if (auto Sym = CXXRuntimeOverrides.searchOverrides(Name))
+          return Sym;
+        if (auto Addr = RTDyldMemoryManager::getSymbolAddressInProcess(Name))
+          return RuntimeDyld::SymbolInfo(Addr, JITSymbolFlags::Exported);
+        return RuntimeDyld::SymbolInfo(nullptr);
+      },
+      [](const std::string &Name) {
+        return RuntimeDyld::SymbolInfo(nullptr);
+      }
+    );
+
+  std::vector<std::unique_ptr<Module>> S;
+  S.push_back(std::move(*M));
+  auto H = Tier2->CompileLayer.addModuleSet(
+      std::move(S), llvm::make_unique<SectionMemoryManager>(),
+      std::move(Resolver));
+
+  auto Body = Tier2->CompileLayer.findSymbolIn(H, TF.Name, false);
+  if (Body && CODLayer.updatePointer(TF.Name, Body.getAddress()))
+    DEBUG(dbgs() << "Recompiled hot function " << TF.Name << "\n");
+}
+
 // Defined in lli.cpp.
 CodeGenOpt::Level getOptLevel();
 
@@ -140,8 +319,15 @@ int llvm::runOrcLazyJIT(std::unique_ptr<Module> M, int ArgC, char* ArgV[]) {
   // Grab a target machine and try to build a factory function for the
   // target-specific Orc callback manager.
   EngineBuilder EB;
-  EB.setOptLevel(getOptLevel());
+  // In tiered mode the first tier compiles as fast as it can, with FastISel,
+  // and the second one at the requested level, but at least -O2.
+  EB.setOptLevel(OrcTiered ? CodeGenOpt::None : getOptLevel());
   auto TM = std::unique_ptr<TargetMachine>(EB.selectTarget());
+  std::unique_ptr<TargetMachine> Tier2TM;
+  if (OrcTiered) {
+    EB.setOptLevel(std::max(getOptLevel(), CodeGenOpt::Default));
+    Tier2TM.reset(EB.selectTarget());
+  }
   auto CompileCallbackMgr =
     OrcLazyJIT::createCompileCallbackMgr(Triple(TM->getTargetTriple()));
 
@@ -163,10 +349,27 @@ int llvm::runOrcLazyJIT(std::unique_ptr<Module> M, int ArgC, char* ArgV[]) {
     return 1;
   }
 
+  // The cached objects are only valid for the same target and options. The
+  // first tier embeds the addresses of its counters in the code, which would
+  // never hit the cache.
+  std::unique_ptr<orc::PersistentObjectCache> Cache;
+  if (!OrcCacheDir.empty() && !OrcTiered)
+    Cache = llvm::make_unique<orc::PersistentObjectCache>(
+        OrcCacheDir, TM->getTargetTriple().str() + "|" +
+                         TM->getTargetCPU().str() + "|" +
+                         TM->getTargetFeatureString().str() + "|" +
+                         utostr(getOptLevel()));
+
   // Everything looks good. Build the JIT.
   OrcLazyJIT J(std::move(TM), std::move(CompileCallbackMgr),
                std::move(IndirectStubsMgrBuilder),
                OrcInlineStubs);
+  if (Cache)
+    J.setObjectCache(Cache.get());
+  if (OrcSpeculate)
+    J.enableSpeculativeCompilation();
+  if (OrcTiered)
+    J.enableTieredCompilation(std::move(Tier2TM), OrcTierUpThreshold);
 
   // Add the module, look up main and run it.
   auto MainHandle = J.addModule(std::move(M));
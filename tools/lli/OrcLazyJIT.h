@@ -8,7 +8,8 @@
 //===----------------------------------------------------------------------===//
 //
 // Simple Orc-based JIT. Uses the compile-on-demand layer to break up and
-// lazily compile modules.
+// lazily compile modules, and optionally recompiles the hot functions with
+// more optimization.
 //
 //===----------------------------------------------------------------------===//
 
@@ -23,6 +24,8 @@
 #include "llvm/ExecutionEngine/Orc/IRTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
+#include "llvm/Support/ThreadPool.h"
+#include <deque>
 
 namespace llvm {
 
@@ -48,7 +51,7 @@ public:
 	CCMgr(std::move(CCMgr)),
 	ObjectLayer(),
         CompileLayer(ObjectLayer, orc::SimpleCompiler(*this->TM)),
-        IRDumpLayer(CompileLayer, createDebugDumper()),
+        IRDumpLayer(CompileLayer, createTransform()),
         CODLayer(IRDumpLayer, extractSingleFunction, *this->CCMgr,
                  std::move(IndirectStubsMgrBuilder), InlineStubs),
         CXXRuntimeOverrides(
@@ -127,6 +130,26 @@ public:
     return CODLayer.findSymbolIn(H, mangle(Name), true);
   }
 
+  /// Query Cache before compiling the partitions. The cache is not owned.
+  void setObjectCache(ObjectCache *Cache) {
+    CompileLayer.setObjectCache(Cache);
+  }
+
+  /// Compile the callees of each compiled function in the background.
+  void enableSpeculativeCompilation() {
+    CODLayer.enableSpeculativeCompilation();
+  }
+
+  /// Count the calls and loop iterations of each function compiled from now
+  /// on, and once a function reaches Threshold, recompile it with Tier2TM and
+  /// its IR optimizations on a background thread and point its stub at the
+  /// new body. The JIT's own target machine should then be a fast one, e.g.
+  /// at -O0, which selects instructions with FastISel.
+  void enableTieredCompilation(std::unique_ptr<TargetMachine> Tier2TM,
+                               unsigned Threshold) {
+    Tier2 = llvm::make_unique<Tier2Compiler>(std::move(Tier2TM), Threshold);
+  }
+
 private:
 
   std::string mangle(const std::string &Name) {
@@ -145,6 +168,45 @@ private:
   }
 
   static TransformFtor createDebugDumper();
+  TransformFtor createTransform();
+
+  /// A function compiled by the first tier.
+  struct TieredFunction {
+    TieredFunction(OrcLazyJIT &JIT, std::string Name)
+        : JIT(JIT), Name(std::move(Name)), Counter(0) {}
+
+    OrcLazyJIT &JIT;
+    std::string Name;
+    /// The IR of its partition, before instrumentation. The partitions share
+    /// the JIT's LLVMContext, so the second tier reads its own copy.
+    SmallVector<char, 0> Bitcode;
+    /// Bumped by the instrumented code, without synchronization: the count is
+    /// only a heuristic.
+    uint64_t Counter;
+  };
+
+  /// The state of the second tier. Only its thread touches the target
+  /// machine and the layers.
+  struct Tier2Compiler {
+    Tier2Compiler(std::unique_ptr<TargetMachine> TM, unsigned Threshold)
+        : TM(std::move(TM)), Threshold(std::max(Threshold, 1u)),
+          CompileLayer(ObjectLayer, orc::SimpleCompiler(*this->TM)),
+          Pool(1) {}
+
+    std::unique_ptr<TargetMachine> TM;
+    unsigned Threshold;
+    ObjLayerT ObjectLayer;
+    CompileLayerT CompileLayer;
+    /// Appended to under the compile-on-demand layer's lock, which the
+    /// transforms run under; the elements never move.
+    std::deque<TieredFunction> Functions;
+    /// Declared last so that it is joined before the rest is destroyed.
+    ThreadPool Pool;
+  };
+
+  std::unique_ptr<Module> addTierUpCounters(std::unique_ptr<Module> M);
+  static void tierUp(TieredFunction *TF);
+  void recompile(TieredFunction &TF);
 
   std::unique_ptr<TargetMachine> TM;
   DataLayout DL;
@@ -158,6 +220,9 @@ private:
 
   orc::LocalCXXRuntimeOverrides CXXRuntimeOverrides;
   std::vector<orc::CtorDtorRunner<CODLayerT>> IRStaticDestructorRunners;
+
+  /// Destroyed first: the second tier updates the stubs of CODLayer.
+  std::unique_ptr<Tier2Compiler> Tier2;
 };
 
 int runOrcLazyJIT(std::unique_ptr<Module> M, int ArgC, char* ArgV[]);
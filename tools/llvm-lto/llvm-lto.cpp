@@ -19,6 +19,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/LTO/LTOCodeGenerator.h"
 #include "llvm/LTO/LTOModule.h"
+#include "llvm/LTO/ThinLTOCodeGenerator.h"
 #include "llvm/Object/FunctionIndexObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
@@ -64,6 +65,41 @@ static cl::opt<bool>
     ThinLTO("thinlto", cl::init(false),
             cl::desc("Only write combined global index for ThinLTO backends"));
 
+enum ThinLTOModes {
+  THINLINK,
+  THINALL
+};
+
+static cl::opt<ThinLTOModes> ThinLTOMode(
+    "thinlto-action", cl::desc("Perform a ThinLTO stage:"),
+    cl::values(
+        clEnumValN(THINLINK, "thinlink",
+                   "ThinLink: produces the index by linking only the "
+                   "summaries."),
+        clEnumValN(THINALL, "run",
+                   "Perform ThinLTO end-to-end: import, optimize and "
+                   "codegen every input module in parallel, emitting one "
+                   "object file per input."),
+        clEnumValEnd));
+
+static cl::opt<std::string>
+    ThinLTOCacheDir("thinlto-cache-dir",
+                    cl::desc("Enable the ThinLTO backend cache in the given "
+                             "directory"));
+
+static cl::opt<unsigned> ThinLTOCachePruningInterval(
+    "thinlto-cache-pruning-interval", cl::init(1200),
+    cl::desc("Minimum interval in seconds between two prunings of the "
+             "ThinLTO cache"));
+
+static cl::opt<unsigned> ThinLTOCacheEntryExpiration(
+    "thinlto-cache-entry-expiration", cl::init(7 * 24 * 3600),
+    cl::desc("Remove ThinLTO cache entries unused for this many seconds"));
+
+static cl::opt<unsigned long long> ThinLTOCacheMaxSize(
+    "thinlto-cache-max-size", cl::init(0),
+    cl::desc("Prune the ThinLTO cache down to this many bytes (0: no limit)"));
+
 static cl::opt<bool>
 SaveModuleFile("save-merged-module", cl::init(false),
                cl::desc("Write merged LTO module to file before CodeGen"));
@@ -98,6 +134,11 @@ static cl::opt<bool> SetMergedModule(
 static cl::opt<unsigned> Parallelism("j", cl::Prefix, cl::init(1),
                                      cl::desc("Number of backend threads"));
 
+static cl::opt<unsigned>
+    OptParallelism("opt-threads", cl::init(1),
+                   cl::desc("Number of threads running the scalar "
+                            "optimizations on partitions of the module"));
+
 static cl::opt<bool> RestoreGlobalsLinkage(
     "restore-linkage", cl::init(false),
     cl::desc("Restore original linkage of globals prior to CodeGen"));
@@ -238,6 +279,50 @@ static void createCombinedFunctionIndex() {
   OS.close();
 }
 
+/// Run the complete ThinLTO pipeline: link the combined index, then import,
+/// optimize and codegen every input module on a thread pool. The object file
+/// for each input is written next to it with a ".thinlto.o" suffix.
+static void runThinLTO(const TargetOptions &Options) {
+  // Keep the input buffers alive, the code generator only references them.
+  std::vector<std::unique_ptr<MemoryBuffer>> InputBuffers;
+  ThinLTOCodeGenerator ThinGenerator;
+  for (auto &Filename : InputFilenames) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFile(Filename);
+    error(BufferOrErr, "error loading file '" + Filename + "'");
+    InputBuffers.push_back(std::move(*BufferOrErr));
+    ThinGenerator.addModule(Filename, InputBuffers.back()->getBuffer());
+  }
+
+  ThinGenerator.setTargetOptions(Options);
+  ThinGenerator.setCodePICModel(RelocModel);
+  ThinGenerator.setCpu(MCPU);
+  std::string Attrs;
+  for (unsigned i = 0; i < MAttrs.size(); ++i) {
+    if (i > 0)
+      Attrs.append(",");
+    Attrs.append(MAttrs[i]);
+  }
+  ThinGenerator.setAttr(Attrs);
+  ThinGenerator.setOptLevel(OptLevel - '0');
+  ThinGenerator.setThreadCount(Parallelism);
+  ThinGenerator.setCacheDir(ThinLTOCacheDir);
+  ThinGenerator.setCachePruningInterval(ThinLTOCachePruningInterval);
+  ThinGenerator.setCacheEntryExpiration(ThinLTOCacheEntryExpiration);
+  ThinGenerator.setCacheMaxSize(ThinLTOCacheMaxSize);
+
+  ThinGenerator.run();
+
+  auto &Binaries = ThinGenerator.getProducedBinaries();
+  for (unsigned BufID = 0; BufID < Binaries.size(); ++BufID) {
+    std::string OutputName = InputFilenames[BufID] + ".thinlto.o";
+    std::error_code EC;
+    raw_fd_ostream OS(OutputName, EC, sys::fs::OpenFlags::F_None);
+    error(EC, "error opening the file '" + OutputName + "'");
+    OS << StringRef(Binaries[BufID].data(), Binaries[BufID].size());
+  }
+}
+
 int main(int argc, char **argv) {
   // Print a stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal();
@@ -263,6 +348,19 @@ int main(int argc, char **argv) {
     return 0;
   }
 
+  if (ThinLTOMode.getNumOccurrences()) {
+    switch (ThinLTOMode) {
+    case THINLINK:
+      if (OutputFilename.empty())
+        error("-thinlto-action=thinlink requires -o");
+      createCombinedFunctionIndex();
+      return 0;
+    case THINALL:
+      runThinLTO(Options);
+      return 0;
+    }
+  }
+
   if (ThinLTO) {
     createCombinedFunctionIndex();
     return 0;
@@ -332,6 +430,7 @@ int main(int argc, char **argv) {
   CodeGen.setCpu(MCPU.c_str());
 
   CodeGen.setOptLevel(OptLevel - '0');
+  CodeGen.setOptParallelism(OptParallelism);
 
   std::string attrs;
   for (unsigned i = 0; i < MAttrs.size(); ++i) {
@@ -15,6 +15,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/DebugInfo/Symbolize/DIPrinter.h"
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
@@ -23,13 +24,16 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <vector>
 
 using namespace llvm;
 using namespace symbolize;
@@ -86,9 +90,27 @@ static cl::opt<int> ClPrintSourceContextLines(
     "print-source-context-lines", cl::init(0),
     cl::desc("Print N number of source file context"));
 
+static cl::opt<unsigned> ClThreads(
+    "threads", cl::init(1),
+    cl::desc("Read the input in batches and symbolize the addresses of "
+             "different modules on N threads. The output keeps the order of "
+             "the input"));
+
+static cl::opt<unsigned> ClBatchSize(
+    "batch-size", cl::init(1 << 16),
+    cl::desc("Number of input lines symbolized together with -threads"));
+
+static cl::opt<unsigned> ClMaxOpenModules(
+    "max-open-modules", cl::init(0),
+    cl::desc("Maximum number of modules kept open; the least recently used "
+             "one is closed first (0 = no limit)"));
+
+static ManagedStatic<sys::SmartMutex<true>> ErrorLock;
+
 static bool error(std::error_code ec) {
   if (!ec)
     return false;
+  sys::SmartScopedLock<true> Guard(*ErrorLock);
   errs() << "LLVMSymbolizer: error reading file: " << ec.message() << ".\n";
   return true;
 }
@@ -136,6 +158,48 @@ static bool parseCommand(StringRef InputString, bool &IsData,
   return !StringRef(pos, offset_length).getAsInteger(0, ModuleOffset);
 }
 
+static bool readLine(std::string &Line) {
+  const int kMaxInputStringLength = 1024;
+  char InputString[kMaxInputStringLength];
+  if (!fgets(InputString, sizeof(InputString), stdin))
+    return false;
+  Line = InputString;
+  return true;
+}
+
+// Symbolizes one line of input and prints the answer to OS.
+static void symbolizeInput(LLVMSymbolizer &Symbolizer, StringRef InputString,
+                           raw_ostream &OS) {
+  bool IsData = false;
+  std::string ModuleName;
+  uint64_t ModuleOffset = 0;
+  if (!parseCommand(InputString, IsData, ModuleName, ModuleOffset)) {
+    OS << InputString;
+    return;
+  }
+
+  DIPrinter Printer(OS, ClPrintFunctions != FunctionNameKind::None,
+                    ClPrettyPrint, ClPrintSourceContextLines);
+  if (ClPrintAddress) {
+    OS << "0x";
+    OS.write_hex(ModuleOffset);
+    StringRef Delimiter = (ClPrettyPrint == true) ? ": " : "\n";
+    OS << Delimiter;
+  }
+  if (IsData) {
+    auto ResOrErr = Symbolizer.symbolizeData(ModuleName, ModuleOffset);
+    Printer << (error(ResOrErr.getError()) ? DIGlobal() : ResOrErr.get());
+  } else if (ClPrintInlining) {
+    auto ResOrErr = Symbolizer.symbolizeInlinedCode(ModuleName, ModuleOffset);
+    Printer << (error(ResOrErr.getError()) ? DIInliningInfo()
+                                           : ResOrErr.get());
+  } else {
+    auto ResOrErr = Symbolizer.symbolizeCode(ModuleName, ModuleOffset);
+    Printer << (error(ResOrErr.getError()) ? DILineInfo() : ResOrErr.get());
+  }
+  OS << "\n";
+}
+
 int main(int argc, char **argv) {
   // Print stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal();
@@ -146,7 +210,8 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "llvm-symbolizer\n");
   LLVMSymbolizer::Options Opts(ClPrintFunctions, ClUseSymbolTable, ClDemangle,
-                               ClUseRelativeAddress, ClDefaultArch);
+                               ClUseRelativeAddress, ClDefaultArch,
+                               ClMaxOpenModules);
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -158,43 +223,58 @@ int main(int argc, char **argv) {
   }
   LLVMSymbolizer Symbolizer(Opts);
 
-  DIPrinter Printer(outs(), ClPrintFunctions != FunctionNameKind::None,
-                    ClPrettyPrint, ClPrintSourceContextLines);
-
-  const int kMaxInputStringLength = 1024;
-  char InputString[kMaxInputStringLength];
+  if (ClThreads <= 1) {
+    // Answer each line as soon as it is read: the sanitizers talk to the
+    // symbolizer through a pipe.
+    std::string InputString;
+    while (readLine(InputString)) {
+      symbolizeInput(Symbolizer, InputString, outs());
+      outs().flush();
+    }
+    return 0;
+  }
 
-  while (true) {
-    if (!fgets(InputString, sizeof(InputString), stdin))
-      break;
-
-    bool IsData = false;
-    std::string ModuleName;
-    uint64_t ModuleOffset = 0;
-    if (!parseCommand(StringRef(InputString), IsData, ModuleName,
-                      ModuleOffset)) {
-      outs() << InputString;
-      continue;
+  ThreadPool Pool(ClThreads);
+  std::vector<std::string> Inputs;
+  std::vector<std::string> Results;
+  unsigned BatchSize = std::max(1U, (unsigned)ClBatchSize);
+  bool Done = false;
+  while (!Done) {
+    Inputs.clear();
+    std::string InputString;
+    while (Inputs.size() < BatchSize) {
+      if (!readLine(InputString)) {
+        Done = true;
+        break;
+      }
+      Inputs.push_back(InputString);
     }
 
-    if (ClPrintAddress) {
-      outs() << "0x";
-      outs().write_hex(ModuleOffset);
-      StringRef Delimiter = (ClPrettyPrint == true) ? ": " : "\n";
-      outs() << Delimiter;
+    // Group the lines by module, so that the addresses of one module are
+    // resolved by a single task while the modules run in parallel.
+    StringMap<std::vector<size_t>> LinesForModule;
+    for (size_t I = 0, E = Inputs.size(); I != E; ++I) {
+      bool IsData;
+      std::string ModuleName;
+      uint64_t ModuleOffset;
+      parseCommand(Inputs[I], IsData, ModuleName, ModuleOffset);
+      LinesForModule[ModuleName].push_back(I);
     }
-    if (IsData) {
-      auto ResOrErr = Symbolizer.symbolizeData(ModuleName, ModuleOffset);
-      Printer << (error(ResOrErr.getError()) ? DIGlobal() : ResOrErr.get());
-    } else if (ClPrintInlining) {
-      auto ResOrErr = Symbolizer.symbolizeInlinedCode(ModuleName, ModuleOffset);
-      Printer << (error(ResOrErr.getError()) ? DIInliningInfo()
-                                             : ResOrErr.get());
-    } else {
-      auto ResOrErr = Symbolizer.symbolizeCode(ModuleName, ModuleOffset);
-      Printer << (error(ResOrErr.getError()) ? DILineInfo() : ResOrErr.get());
+
+    Results.assign(Inputs.size(), std::string());
+    for (auto &Module : LinesForModule) {
+      std::vector<size_t> &Lines = Module.second;
+      Pool.async([&Symbolizer, &Inputs, &Results, &Lines] {
+        for (size_t I : Lines) {
+          raw_string_ostream OS(Results[I]);
+          symbolizeInput(Symbolizer, Inputs[I], OS);
+        }
+      });
     }
-    outs() << "\n";
+    Pool.wait();
+
+    for (const std::string &Result : Results)
+      outs() << Result;
     outs().flush();
   }
 
@@ -0,0 +1,93 @@
+//===- PersistentObjectCacheTest.cpp - Unit tests for the on-disk cache ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class PersistentObjectCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        sys::fs::createUniqueDirectory("orc-object-cache", CacheDir));
+  }
+
+  void TearDown() override {
+    std::error_code EC;
+    for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+         I.increment(EC))
+      sys::fs::remove(I->path());
+    sys::fs::remove(CacheDir);
+  }
+
+  // Build a module holding "i32 @f() { ret i32 Value }".
+  std::unique_ptr<Module> createModule(int Value) {
+    auto M = llvm::make_unique<Module>("test", Context);
+    auto *F = Function::Create(
+        FunctionType::get(Type::getInt32Ty(Context), false),
+        GlobalValue::ExternalLinkage, "f", M.get());
+    IRBuilder<> B(BasicBlock::Create(Context, "entry", F));
+    B.CreateRet(B.getInt32(Value));
+    return M;
+  }
+
+  LLVMContext Context;
+  SmallString<128> CacheDir;
+};
+
+const char ObjectBytes[] = "not really an object";
+
+TEST_F(PersistentObjectCacheTest, HitAcrossInstances) {
+  auto M = createModule(1);
+  {
+    PersistentObjectCache Cache(CacheDir.str(), "sig");
+    EXPECT_EQ(nullptr, Cache.getObject(M.get()));
+    Cache.notifyObjectCompiled(M.get(),
+                               MemoryBufferRef(ObjectBytes, "f.o"));
+  }
+
+  PersistentObjectCache Cache(CacheDir.str(), "sig");
+  auto Obj = Cache.getObject(createModule(1).get());
+  ASSERT_NE(nullptr, Obj);
+  EXPECT_EQ(StringRef(ObjectBytes), Obj->getBuffer());
+}
+
+TEST_F(PersistentObjectCacheTest, KeyedByIRAndSignature) {
+  auto M = createModule(1);
+  PersistentObjectCache Cache(CacheDir.str(), "sig");
+  EXPECT_EQ(nullptr, Cache.getObject(M.get()));
+  Cache.notifyObjectCompiled(M.get(), MemoryBufferRef(ObjectBytes, "f.o"));
+
+  // Same name, different body.
+  EXPECT_EQ(nullptr, Cache.getObject(createModule(2).get()));
+
+  // Same IR, other target or options.
+  PersistentObjectCache OtherCache(CacheDir.str(), "other-sig");
+  EXPECT_EQ(nullptr, OtherCache.getObject(M.get()));
+  EXPECT_NE(Cache.getCachePath(*M), OtherCache.getCachePath(*M));
+}
+
+TEST_F(PersistentObjectCacheTest, UnqueriedModulesAreNotStored) {
+  // IRCompileLayer only hands back the objects it looked up first.
+  auto M = createModule(1);
+  PersistentObjectCache Cache(CacheDir.str(), "sig");
+  Cache.notifyObjectCompiled(M.get(), MemoryBufferRef(ObjectBytes, "f.o"));
+  EXPECT_FALSE(sys::fs::exists(Cache.getCachePath(*M)));
+}
+
+} // end anonymous namespace
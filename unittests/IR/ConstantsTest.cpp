@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/AsmParser/Parser.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/InstrTypes.h"
@@ -17,6 +18,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm-c/Core.h"
 #include "gtest/gtest.h"
+#include <thread>
 
 namespace llvm {
 namespace {
@@ -451,5 +453,39 @@ TEST(ConstantsTest, BitcastToGEP) {
             Instruction::BitCast);
 }
 
+#if LLVM_ENABLE_THREADS
+TEST(ConstantsTest, ThreadSafeUniquing) {
+  LLVMContext Context;
+  Context.setThreadSafeUniquing(true);
+  ASSERT_TRUE(Context.hasThreadSafeUniquing());
+  Module M("MyModule", Context);
+  auto *G = new GlobalVariable(M, Type::getInt32Ty(Context), false,
+                               GlobalValue::ExternalLinkage, nullptr, "G");
+
+  const unsigned NumThreads = 4;
+  const unsigned NumValues = 64;
+  std::vector<std::vector<Constant *>> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T)
+    Threads.emplace_back([&Context, &Results, G, T, NumValues] {
+      for (unsigned I = 0; I != NumValues; ++I) {
+        Type *Ty = ArrayType::get(Type::getIntNTy(Context, 8 + I % 8), I);
+        Constant *C = ConstantInt::get(Type::getInt64Ty(Context), I);
+        Constant *E = ConstantExpr::getAdd(
+            ConstantExpr::getPtrToInt(G, Type::getInt64Ty(Context)), C);
+        Results[T].push_back(C);
+        Results[T].push_back(E);
+        Results[T].push_back(ConstantAggregateZero::get(Ty));
+      }
+    });
+  for (std::thread &Th : Threads)
+    Th.join();
+
+  // Every thread got the same uniqued constants.
+  for (unsigned T = 1; T != NumThreads; ++T)
+    EXPECT_EQ(Results[0], Results[T]);
+}
+#endif
+
 }  // end anonymous namespace
 }  // end namespace llvm
@@ -11,6 +11,7 @@
 #include "llvm/Support/Endian.h"
 #include "gtest/gtest.h"
 #include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -91,4 +92,29 @@ TEST(StringTableBuilderTest, ELFInOrder) {
   EXPECT_EQ(9U, B.getOffset("foobar"));
 }
 
+TEST(StringTableBuilderTest, ParallelELF) {
+  // Enough strings to sort them in parallel, many of which are suffixes of
+  // each other.
+  std::vector<std::string> Strings;
+  for (unsigned I = 0; I != 40000; ++I)
+    Strings.push_back("_Z" + std::to_string(I * 7919 % 40000) + "fooIiE" +
+                      std::string(I % 5, 'v'));
+  for (unsigned I = 0; I != 200; ++I)
+    Strings.push_back(std::to_string(I) + "fooIiE");
+
+  StringTableBuilder Serial(StringTableBuilder::ELF);
+  StringTableBuilder Parallel(StringTableBuilder::ELF);
+  Parallel.setParallelism(4);
+  for (const std::string &S : Strings) {
+    Serial.add(S);
+    Parallel.add(S);
+  }
+  Serial.finalize();
+  Parallel.finalize();
+
+  EXPECT_EQ(Serial.data(), Parallel.data());
+  for (const std::string &S : Strings)
+    EXPECT_EQ(Serial.getOffset(S), Parallel.getOffset(S));
+}
+
 }
@@ -137,6 +137,68 @@ TEST_P(MaybeSparseInstrProfTest, get_function_counts) {
   ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, EC));
 }
 
+TEST_P(MaybeSparseInstrProfTest, repeated_lookups) {
+  // Enough functions to have collisions in the record cache of the reader.
+  for (unsigned I = 0; I < 64; ++I)
+    Writer.addRecord(InstrProfRecord("func" + utostr(I), 0x1234, {I + 1, 2 * I}));
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  for (unsigned Round = 0; Round < 2; ++Round)
+    for (unsigned I = 0; I < 64; ++I) {
+      std::string Name = "func" + utostr(I);
+      ErrorOr<InstrProfRecord> R = Reader->getInstrProfRecord(Name, 0x1234);
+      ASSERT_TRUE(NoError(R.getError()));
+      ASSERT_EQ(StringRef(Name), R.get().Name);
+      ASSERT_EQ(2U, R.get().Counts.size());
+      ASSERT_EQ(uint64_t(I + 1), R.get().Counts[0]);
+      ASSERT_EQ(uint64_t(2 * I), R.get().Counts[1]);
+      R = Reader->getInstrProfRecord(Name, 0x5678);
+      ASSERT_TRUE(ErrorEquals(instrprof_error::hash_mismatch, R.getError()));
+    }
+}
+
+TEST_P(MaybeSparseInstrProfTest, merge_records_from_writer) {
+  InstrProfWriter Writer2;
+  InstrProfRecord Record1("foo", 0x1234, {1, 2});
+  InstrProfRecord Record2("foo", 0x1234, {3, 4});
+  InstrProfRecord Record3("bar", 0x1234, {5, 6});
+  InstrProfRecord Record4("foo", 0x1234, {1, 2, 3});
+  Writer.addRecord(std::move(Record1));
+  Writer2.addRecord(std::move(Record2), 2);
+  Writer2.addRecord(std::move(Record3));
+
+  unsigned NumErrors = 0;
+  Writer.mergeRecordsFromWriter(
+      std::move(Writer2),
+      [&](std::error_code, StringRef) { ++NumErrors; });
+  ASSERT_EQ(0U, NumErrors);
+
+  InstrProfWriter Writer3;
+  Writer3.addRecord(std::move(Record4));
+  Writer.mergeRecordsFromWriter(
+      std::move(Writer3), [&](std::error_code EC, StringRef FuncName) {
+        ASSERT_TRUE(ErrorEquals(instrprof_error::count_mismatch, EC));
+        ASSERT_EQ(StringRef("foo"), FuncName);
+        ++NumErrors;
+      });
+  ASSERT_EQ(1U, NumErrors);
+
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  std::vector<uint64_t> Counts;
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("foo", 0x1234, Counts)));
+  ASSERT_EQ(2U, Counts.size());
+  ASSERT_EQ(7U, Counts[0]);
+  ASSERT_EQ(10U, Counts[1]);
+
+  ASSERT_TRUE(NoError(Reader->getFunctionCounts("bar", 0x1234, Counts)));
+  ASSERT_EQ(2U, Counts.size());
+  ASSERT_EQ(5U, Counts[0]);
+  ASSERT_EQ(6U, Counts[1]);
+}
+
 // Profile data is copied from general.proftext
 TEST_F(InstrProfTest, get_profile_summary) {
   InstrProfRecord Record1("func1", 0x1234, {97531});
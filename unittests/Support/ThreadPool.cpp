@@ -166,3 +166,58 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, ManyTasks) {
+  CHECK_UNSUPPORTED();
+  // Test that tasks submitted from outside are all run, whatever the deque
+  // they end up in.
+  std::atomic_int checked_in{0};
+
+  ThreadPool Pool(4);
+  for (size_t i = 0; i < 1000; ++i)
+    Pool.async([&checked_in] { ++checked_in; });
+  Pool.wait();
+  ASSERT_EQ(1000, checked_in);
+}
+
+TEST_F(ThreadPoolTest, TaskGroupNested) {
+  CHECK_UNSUPPORTED();
+  // Test that a task can wait on its own children without deadlocking the
+  // pool, even when every thread of the pool is waiting on a group.
+  std::atomic_int checked_in{0};
+
+  ThreadPool Pool(2);
+  for (size_t i = 0; i < 4; ++i) {
+    Pool.async([&Pool, &checked_in] {
+      ThreadPool::TaskGroup Group(Pool);
+      for (size_t j = 0; j < 10; ++j)
+        Group.async([&checked_in] { ++checked_in; });
+      Group.wait();
+      ++checked_in;
+    });
+  }
+  Pool.wait();
+  ASSERT_EQ(44, checked_in);
+}
+
+TEST_F(ThreadPoolTest, TaskGroupFromOutside) {
+  CHECK_UNSUPPORTED();
+  // Test that a group only waits for its own tasks.
+  std::atomic_int checked_in{0};
+
+  ThreadPool Pool(2);
+  Pool.async([this, &checked_in] {
+    waitForMainThread();
+    ++checked_in;
+  });
+  {
+    ThreadPool::TaskGroup Group(Pool);
+    for (size_t i = 0; i < 5; ++i)
+      Group.async(TestFunc, std::ref(checked_in), 1);
+    Group.wait();
+    ASSERT_EQ(5, checked_in);
+  }
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(6, checked_in);
+}
@@ -312,7 +312,8 @@ void CodeGenTarget::ComputeInstrsByEnum() const {
       "LIFETIME_END", "STACKMAP",      "PATCHPOINT",       "LOAD_STACK_GUARD",
       "STATEPOINT",   "LOCAL_ESCAPE",   "FAULTING_LOAD_OP",
       // Generic opcodes for GlobalISel start here.
-      "G_ADD",
+      "G_ADD",        "G_SUB",         "G_AND",            "G_OR",
+      "G_XOR",        "G_BR",
       nullptr};
   const auto &Insts = getInstructions();
   for (const char *const *p = FixedInstrs; *p; ++p) {